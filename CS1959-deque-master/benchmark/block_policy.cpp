@@ -0,0 +1,96 @@
+// block size policies per element type, on a block-mode workload:
+// middle inserts and erases, random access and a full scan.
+// build: g++ -std=c++17 -O2 -I.. block_policy.cpp -o block_policy
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+struct Record {
+    double field[8];
+    Record(int x = 0) {
+        for (int i = 0; i < 8; i++)
+            field[i] = x + i;
+    }
+};
+
+int make(int x, int*) { return x; }
+Record make(int x, Record*) { return Record(x); }
+Diamond::Matrix<double> make(int x, Diamond::Matrix<double>*) {
+    return Diamond::Matrix<double>(2, 2, x);
+}
+
+template <class T, class Policy>
+double workload(size_t n) {
+    std::mt19937 rng(1959);
+    sjtu::deque<T, 0, Policy> deq;
+    Timer timer;
+    for (size_t i = 0; i < n; i++)
+        deq.push_back(make(i, (T*)nullptr));
+    for (size_t i = 0; i < n / 10; i++)
+        deq.insert(deq.begin() + rng() % (deq.size() + 1), make(i, (T*)nullptr));
+    size_t touched = 0;
+    for (size_t i = 0; i < n; i++)
+        touched += &deq[rng() % deq.size()] != nullptr;
+    for (auto it = deq.begin(); it != deq.end(); ++it)
+        touched += &*it != nullptr;
+    for (size_t i = 0; i < n / 10; i++)
+        deq.erase(deq.begin() + rng() % deq.size());
+    return touched ? timer.ms() : 0;
+}
+
+template <class T>
+void row(const char* name, size_t n) {
+    double cost[] = {
+        workload<T, sjtu::count_block_policy>(n),
+        workload<T, sjtu::page_block_policy>(n),
+        workload<T, sjtu::l1_block_policy>(n),
+        workload<T, sjtu::l2_block_policy>(n),
+    };
+    const char* policy[] = {"count", "page", "l1", "l2"};
+    int best = 0;
+    for (int i = 1; i < 4; i++)
+        if (cost[i] < cost[best])
+            best = i;
+    printf("%-16s", name);
+    for (int i = 0; i < 4; i++)
+        printf("%12.1f", cost[i]);
+    printf("%10s\n", policy[best]);
+}
+
+int main() {
+    printf("ms per workload and policy\n");
+    printf("%-16s%12s%12s%12s%12s%10s\n", "", "count", "page", "l1", "l2",
+           "best");
+    row<int>("int", 100000);
+    row<Record>("Record (64 B)", 100000);
+    row<Diamond::Matrix<double>>("Matrix<double>", 20000);
+    printf("\nelements per block: int %zu/%zu/%zu, Record %zu/%zu/%zu, "
+           "Matrix %zu/%zu/%zu\n",
+           sjtu::page_block_policy::block_elements<int>(),
+           sjtu::l1_block_policy::block_elements<int>(),
+           sjtu::l2_block_policy::block_elements<int>(),
+           sjtu::page_block_policy::block_elements<Record>(),
+           sjtu::l1_block_policy::block_elements<Record>(),
+           sjtu::l2_block_policy::block_elements<Record>(),
+           sjtu::page_block_policy::block_elements<Diamond::Matrix<double>>(),
+           sjtu::l1_block_policy::block_elements<Diamond::Matrix<double>>(),
+           sjtu::l2_block_policy::block_elements<Diamond::Matrix<double>>());
+    return 0;
+}
@@ -0,0 +1,73 @@
+// operator[] and iterator scans under checked_access and unchecked_access,
+// in flat mode and in block mode.
+// build: g++ -std=c++17 -O2 -I.. checked_access.cpp -o checked_access
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "deque.hpp"
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+template <class Check>
+using int_deque = sjtu::deque<int, 0, sjtu::page_block_policy, Check>;
+
+static long long sink = 0;
+
+template <class Check>
+long long index_sum(int_deque<Check>& deq) {
+    long long sum = 0;
+    for (size_t i = 0; i < deq.size(); i++)
+        sum += deq[i];
+    return sum;
+}
+template <class Check>
+long long iterator_sum(int_deque<Check>& deq) {
+    long long sum = 0;
+    for (auto it = deq.begin(); it != deq.end(); ++it)
+        sum += *it;
+    return sum;
+}
+
+template <class Check>
+double run(size_t n, int rounds, long long (*sum)(int_deque<Check>&)) {
+    int_deque<Check> deq;
+    for (size_t i = 0; i < n; i++)
+        deq.push_back(i);
+    Timer timer;
+    for (int r = 0; r < rounds; r++)
+        sink += sum(deq);
+    return timer.ms();
+}
+
+void row(const char* name, double checked, double unchecked) {
+    printf("%-28s%12.1f%12.1f%10.2fx\n", name, checked, unchecked,
+           checked / unchecked);
+}
+
+int main() {
+    const size_t flat_n = FLAT_CAPACITY / 2, block_n = 4 * FLAT_CAPACITY;
+    printf("%-28s%12s%12s%11s\n", "ms", "checked", "unchecked", "speedup");
+    using checked = sjtu::checked_access;
+    using unchecked = sjtu::unchecked_access;
+    row("flat, dq[i]", run<checked>(flat_n, 500, index_sum),
+        run<unchecked>(flat_n, 500, index_sum));
+    row("flat, iterator", run<checked>(flat_n, 500, iterator_sum),
+        run<unchecked>(flat_n, 500, iterator_sum));
+    row("blocks, dq[i]", run<checked>(block_n, 1, index_sum),
+        run<unchecked>(block_n, 1, index_sum));
+    row("blocks, iterator", run<checked>(block_n, 20, iterator_sum),
+        run<unchecked>(block_n, 20, iterator_sum));
+    return sink == 42;
+}
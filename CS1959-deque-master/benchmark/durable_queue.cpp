@@ -0,0 +1,55 @@
+// push/pop throughput of durable_deque for several group commit sizes.
+// each batch costs two fdatasync calls, so the batch size trades the
+// number of changes a crash may lose for throughput.
+// build: g++ -std=c++17 -O2 -I.. durable_queue.cpp -o durable_queue
+// run it on the disk the queue would live on: ./durable_queue [dir]
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+#include "deque.hpp"
+#include "durable_deque.hpp"
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+int main(int argc, char** argv) {
+    const char* dir = argc > 1 ? argv[1] : "durable_bench";
+    printf("%-16s%12s%12s%16s\n", "batch", "ops", "syncs", "ops / s");
+    size_t batches[] = {1, 8, 64, 512, 4096};
+    long long check = 0;
+    for (size_t batch : batches) {
+        std::filesystem::remove_all(dir);
+        // fewer ops for the small batches, which sync every few ops
+        size_t ops = std::min(batch * 2000, (size_t)2000000);
+        Timer timer;
+        size_t syncs;
+        {
+            sjtu::durable_deque<long long> deq(dir, batch);
+            for (size_t i = 0; i < ops; i++) {
+                deq.push_back(i);
+                if (deq.size() > 1000) {
+                    check += deq.front();
+                    deq.pop_front();
+                }
+            }
+            deq.commit();
+            syncs = deq.syncs;
+        }
+        double ms = timer.ms();
+        printf("%-16zu%12zu%12zu%16.0f\n", batch, ops, syncs,
+               ops / ms * 1000);
+    }
+    std::filesystem::remove_all(dir);
+    return check < 0;
+}
@@ -0,0 +1,55 @@
+// memory of a feature-flag history: the packed deque<bool> against the
+// node-per-element layout it replaced, measured on a deque<char>; and
+// count() against a loop over the flags.
+// build: g++ -std=c++17 -O2 -I.. flag_history.cpp -o flag_history
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "deque.hpp"
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+int main() {
+    printf("%-24s%14s%14s%10s%14s%14s\n", "", "nodes (B/el)", "bits (B/el)",
+           "ratio", "count (ms)", "loop (ms)");
+    std::mt19937 rng(1);
+    for (size_t n : {100000, 1000000, 10000000}) {
+        sjtu::deque<bool> flags;
+        sjtu::deque<char> chars;
+        for (size_t i = 0; i < n; i++) {
+            bool v = rng() % 10 == 0;
+            flags.push_back(v);
+            chars.push_back(v);
+        }
+        sjtu::deque_stats st = chars.memory_stats();
+        double nodes = (double)(st.element_bytes + st.overhead_bytes) / n;
+        double bits = (double)flags.memory_bytes() / n;
+        Timer t1;
+        size_t a = flags.count();
+        double fast = t1.ms();
+        Timer t2;
+        size_t b = 0;
+        for (auto it = flags.cbegin(); it != flags.cend(); ++it)
+            b += *it;
+        double slow = t2.ms();
+        printf("size %-19zu%14.2f%14.4f%9.0fx%14.3f%14.2f\n", n, nodes, bits,
+               nodes / bits, fast, slow);
+        if (a != b) {
+            printf("mismatch between the counts\n");
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+// push/pop and middle-insert workloads on sjtu::deque, whose layout follows
+// the workload, against std::deque.
+// build: g++ -std=c++17 -O2 -I.. hybrid_layout.cpp -o hybrid_layout
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <random>
+
+#include "deque.hpp"
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+template <class Deque>
+double queueWorkload(size_t depth, size_t ops, long long& check) {
+    Deque deq;
+    Timer timer;
+    for (size_t i = 0; i < ops; i++) {
+        deq.push_back(i);
+        if (deq.size() > depth) {
+            check += deq.front();
+            deq.pop_front();
+        }
+    }
+    return timer.ms();
+}
+
+template <class Deque>
+double middleWorkload(size_t n, size_t ops, long long& check) {
+    std::mt19937 rng(1959);
+    Deque deq;
+    for (size_t i = 0; i < n; i++)
+        deq.push_back(i);
+    Timer timer;
+    for (size_t i = 0; i < ops; i++)
+        deq.insert(deq.begin() + rng() % (deq.size() + 1), i);
+    for (size_t i = 0; i < deq.size(); i += 97)
+        check += deq[i];
+    return timer.ms();
+}
+
+int main() {
+    long long check[2] = {0, 0};
+    printf("%-36s%14s%14s\n", "", "sjtu (ms)", "std (ms)");
+    size_t depths[] = {64, 4096, 50000};
+    for (size_t depth : depths) {
+        double a = queueWorkload<sjtu::deque<int>>(depth, 2000000, check[0]);
+        double b = queueWorkload<std::deque<int>>(depth, 2000000, check[1]);
+        printf("queue, depth %-23zu%14.2f%14.2f\n", depth, a, b);
+    }
+    size_t sizes[] = {1000, 100000, 1000000};
+    for (size_t n : sizes) {
+        double a = middleWorkload<sjtu::deque<int>>(n, 2000, check[0]);
+        double b = middleWorkload<std::deque<int>>(n, 2000, check[1]);
+        printf("middle inserts, size %-15zu%14.2f%14.2f\n", n, a, b);
+    }
+    if (check[0] != check[1]) {
+        printf("mismatch between sjtu and std\n");
+        return 1;
+    }
+    return 0;
+}
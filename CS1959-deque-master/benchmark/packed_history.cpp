@@ -0,0 +1,53 @@
+// memory and scan time of a history buffer of 64-bit integers in a
+// packed_deque, against the 8 bytes an element of a plain array.
+// build: g++ -std=c++17 -O2 -I.. packed_history.cpp -o packed_history
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "packed_deque.hpp"
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+template <class Next>
+void run(const char* name, size_t n, Next next) {
+    sjtu::packed_deque<int64_t> deq;
+    Timer t1;
+    for (size_t i = 0; i < n; i++)
+        deq.push_back(next());
+    double push = t1.ms();
+    Timer t2;
+    int64_t sum = 0;
+    for (size_t i = 0; i < n; i++)
+        sum += deq[i];
+    double scan = t2.ms();
+    double ratio = (double)(n * sizeof(int64_t)) / deq.memory_bytes();
+    printf("%-14s%12.2f%12.2f%12.2f%10.1fx  (%lld)\n", name, push, scan,
+           8.0 * deq.memory_bytes() / n, ratio, (long long)(sum & 0xff));
+}
+
+int main() {
+    const size_t n = 10000000;
+    std::mt19937_64 rng(1);
+    printf("%-14s%12s%12s%12s%11s\n", "", "push (ms)", "scan (ms)",
+           "bits/elem", "ratio");
+    int64_t t = 1700000000000LL, seq = 0;
+    run("timestamps", n, [&] { return t += rng() % 50; });
+    run("sequence ids", n, [&] { return ++seq; });
+    t = 0;
+    run("jittery", n, [&] { return t += (int64_t)(rng() % 2001) - 1000; });
+    run("random", n, [&] { return (int64_t)rng(); });
+    return 0;
+}
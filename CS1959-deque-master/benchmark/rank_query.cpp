@@ -0,0 +1,74 @@
+// rank / k-th smallest queries at 1e6 elements: per-block sorted index
+// versus a plain scan of the range.
+// build: g++ -std=c++17 -O2 -I.. rank_query.cpp -o rank_query
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "deque.hpp"
+
+static const int N = 1000000;
+static const int QUERIES = 200;
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+int main() {
+    std::mt19937 rng(1959);
+    sjtu::deque<int> deq;
+    for (int i = 0; i < N; i++)
+        deq.push_back(rng());
+
+    std::vector<size_t> ls, rs, ks;
+    std::vector<int> xs;
+    for (int i = 0; i < QUERIES; i++) {
+        size_t l = rng() % N, r = rng() % N;
+        if (l > r)
+            std::swap(l, r);
+        ls.push_back(l);
+        rs.push_back(r + 1);
+        ks.push_back(rng() % (r + 1 - l));
+        xs.push_back(rng());
+    }
+
+    long long check[2][2] = {{0, 0}, {0, 0}};
+    double cost[2][2], build = 0;
+    for (int mode = 0; mode < 2; mode++) {
+        if (mode) {
+            // the first indexed query sorts every block
+            deq.enable_rank_index();
+            Timer build_timer;
+            deq.count_less(0, N, 0);
+            build = build_timer.ms();
+        }
+        Timer rank_timer;
+        for (int i = 0; i < QUERIES; i++)
+            check[mode][0] += deq.count_less(ls[i], rs[i], xs[i]);
+        cost[mode][0] = rank_timer.ms();
+        Timer kth_timer;
+        for (int i = 0; i < QUERIES; i++)
+            check[mode][1] += deq.kth_smallest(ls[i], rs[i], ks[i]);
+        cost[mode][1] = kth_timer.ms();
+    }
+    if (check[0][0] != check[1][0] || check[0][1] != check[1][1]) {
+        printf("mismatch between scan and index\n");
+        return 1;
+    }
+
+    printf("%d elements, %d queries each\n", N, QUERIES);
+    printf("%-16s%14s%14s\n", "", "scan (ms)", "index (ms)");
+    printf("%-16s%14.2f%14.2f\n", "count_less", cost[0][0], cost[1][0]);
+    printf("%-16s%14.2f%14.2f\n", "kth_smallest", cost[0][1], cost[1][1]);
+    printf("index build: %.2f ms\n", build);
+    return 0;
+}
@@ -0,0 +1,73 @@
+// time to first element of a saved deque: streaming every element back
+// through operator>>, load() of a binary snapshot, and a mapped_deque view.
+// build: g++ -std=c++17 -O2 -I.. snapshot.cpp -o snapshot
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+#include "deque.hpp"
+#include "mapped_deque.hpp"
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+int main() {
+    const char* text = "snapshot_bench.txt";
+    const char* binary = "snapshot_bench.bin";
+    printf("%-24s%14s%14s%14s\n", "", "text (ms)", "load (ms)", "mmap (ms)");
+    size_t sizes[] = {100000, 1000000, 10000000};
+    long long check[3] = {0, 0, 0};
+    for (size_t n : sizes) {
+        sjtu::deque<long long> deq;
+        for (size_t i = 0; i < n; i++)
+            deq.push_back(i * 7);
+        {
+            std::ofstream os(text);
+            for (auto it = deq.cbegin(); it != deq.cend(); ++it)
+                os << *it << '\n';
+        }
+        deq.save(binary);
+
+        Timer t1;
+        {
+            sjtu::deque<long long> in;
+            std::ifstream is(text);
+            long long x;
+            while (is >> x)
+                in.push_back(x);
+            check[0] += in.at(n / 2);
+        }
+        double a = t1.ms();
+        Timer t2;
+        {
+            sjtu::deque<long long> in;
+            in.load(binary);
+            check[1] += in.at(n / 2);
+        }
+        double b = t2.ms();
+        Timer t3;
+        {
+            sjtu::mapped_deque<long long> view(binary);
+            check[2] += view.at(n / 2);
+        }
+        double c = t3.ms();
+        printf("size %-19zu%14.2f%14.2f%14.3f\n", n, a, b, c);
+    }
+    std::remove(text);
+    std::remove(binary);
+    if (check[0] != check[1] || check[1] != check[2]) {
+        printf("mismatch between the readers\n");
+        return 1;
+    }
+    return 0;
+}
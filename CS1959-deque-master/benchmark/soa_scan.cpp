@@ -0,0 +1,64 @@
+// summing one field of {timestamp, price, qty} records: a deque of
+// structs, iterated, against a soa_deque, one column run at a time and
+// through its iterator.
+// build: g++ -std=c++17 -O2 -I.. soa_scan.cpp -o soa_scan
+
+#include <chrono>
+#include <cstdio>
+
+#include "deque.hpp"
+#include "soa_deque.hpp"
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+struct trade {
+    long long timestamp;
+    double price;
+    int qty;
+};
+
+int main() {
+    printf("%-24s%14s%14s%14s\n", "", "deque (ms)", "segments (ms)",
+           "iterator (ms)");
+    for (size_t n : {100000, 1000000, 4000000}) {
+        sjtu::deque<trade> aos;
+        sjtu::soa_deque<long long, double, int> soa;
+        for (size_t i = 0; i < n; i++) {
+            aos.push_back(trade{(long long)i * 10, i * 0.01, (int)(i % 100)});
+            soa.push_back((long long)i * 10, i * 0.01, (int)(i % 100));
+        }
+        Timer t1;
+        long long a = 0;
+        for (auto it = aos.cbegin(); it != aos.cend(); ++it)
+            a += it->qty;
+        double slow = t1.ms();
+        Timer t2;
+        long long b = 0;
+        soa.for_each_segment<2>([&](const int* data, size_t m) {
+            for (size_t i = 0; i < m; i++)
+                b += data[i];
+        });
+        double fast = t2.ms();
+        Timer t3;
+        long long c = 0;
+        for (auto it = soa.cbegin(); it != soa.cend(); ++it)
+            c += std::get<2>(*it);
+        double iter = t3.ms();
+        printf("size %-19zu%14.2f%14.3f%14.2f\n", n, slow, fast, iter);
+        if (a != b || b != c) {
+            printf("mismatch between the scans\n");
+            return 1;
+        }
+    }
+    return 0;
+}
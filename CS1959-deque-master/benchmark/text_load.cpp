@@ -0,0 +1,75 @@
+// loading whitespace-separated numbers from a text file: operator>> and
+// push_back one at a time, against load_text.
+// build: g++ -std=c++17 -O2 -I.. text_load.cpp -o text_load
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "class-bint.hpp"
+#include "deque.hpp"
+#include "text_loader.hpp"
+
+class Timer {
+    std::chrono::steady_clock::time_point start;
+
+   public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    }
+};
+
+template <class T>
+bool run(const char* name, const char* path, size_t n) {
+    Timer t1;
+    sjtu::deque<T> a;
+    {
+        std::ifstream is(path);
+        T x;
+        while (is >> x)
+            a.push_back(x);
+    }
+    double slow = t1.ms();
+    Timer t2;
+    sjtu::deque<T> b;
+    sjtu::load_text(b, path);
+    double fast = t2.ms();
+    printf("%-10s size %-12zu%14.2f%14.2f%10.1fx\n", name, n, slow, fast,
+           slow / fast);
+    return a.size() == n && b.size() == n && a.at(n / 2) == b.at(n / 2) &&
+           a.back() == b.back();
+}
+
+int main() {
+    const char* path = "text_load_bench.txt";
+    printf("%-28s%14s%14s%11s\n", "", ">> (ms)", "load (ms)", "speedup");
+    bool ok = true;
+    for (size_t n : {100000, 1000000, 10000000}) {
+        {
+            std::ofstream os(path);
+            for (size_t i = 0; i < n; i++)
+                os << (long long)(i * 2654435761u % 1000000007) - 500000000
+                   << (i % 8 ? ' ' : '\n');
+        }
+        ok &= run<int>("int", path, n);
+        ok &= run<double>("double", path, n);
+    }
+    for (size_t n : {10000, 100000}) {
+        {
+            std::ofstream os(path);
+            for (size_t i = 0; i < n; i++)
+                os << i * 2654435761u << std::to_string(i * 40503u) << '\n';
+        }
+        ok &= run<Util::Bint>("Bint", path, n);
+    }
+    std::remove(path);
+    if (!ok) {
+        printf("mismatch between the readers\n");
+        return 1;
+    }
+    return 0;
+}
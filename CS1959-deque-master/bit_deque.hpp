@@ -0,0 +1,312 @@
+#ifndef SJTU_BIT_DEQUE_HPP
+#define SJTU_BIT_DEQUE_HPP
+#include "block_map.hpp"
+#include "exceptions.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+namespace sjtu {
+/**
+ * a deque of Bits-wide unsigned values packed into 64-bit words:
+ * flags at one bit each, or small integers of 4, 8, 12 or 16 bits.
+ * Bits == 1 holds bools, and is what deque<bool> is.
+ * the elements sit in blocks of block_words words, with no node or
+ * pointer per element; a value may straddle two words.
+ * element access hands out a reference proxy that reads and writes
+ * the packed bits, as std::vector<bool> does.
+ * pushes and pops at both ends are O(1). insert and erase shift the
+ * smaller half of one block, split it when full, and merge it with its
+ * neighbour when both are small.
+ * count() adds up the set bits a word at a time with popcount.
+ */
+template <unsigned Bits>
+class bit_deque {
+    static_assert(Bits >= 1 && Bits <= 32, "bit_deque: 1 to 32 bits");
+
+   public:
+    using value_type = typename std::conditional<
+        Bits == 1, bool,
+        typename std::conditional<
+            (Bits <= 8), uint8_t,
+            typename std::conditional<(Bits <= 16), uint16_t,
+                                      uint32_t>::type>::type>::type;
+    static constexpr uint64_t mask = ((uint64_t)1 << Bits) - 1;
+    static constexpr size_t block_words = 128;
+    static constexpr size_t block_elements = block_words * 64 / Bits;
+
+    class block {
+       public:
+        uint64_t words[block_words];
+        // the elements are in slots [head, head + size)
+        size_t head;
+        size_t size = 0;
+
+        // empty, with its elements to start at slot head; the words are
+        // zeroed, so no bits are left undefined
+        explicit block(size_t head) : words(), head(head) {}
+
+        value_type get(size_t slot) const {
+            size_t bit = slot * Bits, w = bit / 64, off = bit % 64;
+            uint64_t v = words[w] >> off;
+            if (off + Bits > 64)
+                v |= words[w + 1] << (64 - off);
+            return (value_type)(v & mask);
+        }
+        void set(size_t slot, uint64_t v) {
+            size_t bit = slot * Bits, w = bit / 64, off = bit % 64;
+            words[w] = (words[w] & ~(mask << off)) | v << off;
+            if (off + Bits > 64)
+                words[w + 1] = (words[w + 1] & ~(mask >> (64 - off))) |
+                               v >> (64 - off);
+        }
+        // copy the element in slot src of from into slot dst
+        void relocate(size_t dst, const block* from, size_t src) {
+            set(dst, from->get(src));
+        }
+        // set bits among the first n bits from bit first on
+        size_t popcount(size_t first, size_t n) const {
+            size_t count = 0;
+            while (n) {
+                size_t w = first / 64, off = first % 64;
+                size_t take = std::min(n, 64 - off);
+                uint64_t v = words[w] >> off;
+                if (take < 64)
+                    v &= ((uint64_t)1 << take) - 1;
+                count += __builtin_popcountll(v);
+                first += take;
+                n -= take;
+            }
+            return count;
+        }
+    };
+
+    /**
+     * a proxy for one element, reading and writing its bits.
+     */
+    class reference {
+       public:
+        block* blk;
+        size_t slot;
+
+       public:
+        reference(block* blk, size_t slot) : blk(blk), slot(slot) {}
+        operator value_type() const { return blk->get(slot); }
+        reference& operator=(value_type value) {
+            blk->set(slot, check(value));
+            return *this;
+        }
+        reference& operator=(const reference& other) {
+            return *this = (value_type)other;
+        }
+    };
+
+    using const_reference = value_type;
+    sized_block_map<block, block_elements> map;
+
+   public:
+    /**
+     * iterators remember their block, so stepping is O(1).
+     * insert and erase invalidate all of them.
+     */
+    using iterator = block_iterator<bit_deque, false>;
+    using const_iterator = block_iterator<bit_deque, true>;
+
+   public:
+    /**
+     * constructors.
+     */
+    bit_deque() {}
+    bit_deque(const bit_deque& other) {
+        for (size_t k = 0; k < other.map.blocks; k++) {
+            block* blk = new block(*other.map.block_at(k));
+            map.insert_block(map.blocks, blk);
+        }
+        map.total_size = other.map.total_size;
+    }
+    bit_deque(bit_deque&& other) noexcept { swap(other); }
+
+    /**
+     * deconstructor.
+     */
+    ~bit_deque() { clear(); }
+
+    /**
+     * assignment operators.
+     */
+    bit_deque& operator=(const bit_deque& other) {
+        if (this != &other) {
+            bit_deque tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+    bit_deque& operator=(bit_deque&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+    void swap(bit_deque& other) noexcept { map.swap(other.map); }
+
+    /**
+     * access a specified element with bound checking. finding the block
+     * walks the blocks from the nearer end.
+     * throw index_out_of_bound if out of bound.
+     */
+    reference at(const size_t& pos) {
+        if (pos >= map.total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        size_t k, j;
+        map.locate(pos, k, j);
+        block* blk = map.block_at(k);
+        return reference(blk, blk->head + j);
+    }
+    value_type at(const size_t& pos) const {
+        return const_cast<bit_deque*>(this)->at(pos);
+    }
+    reference operator[](const size_t& pos) { return at(pos); }
+    value_type operator[](const size_t& pos) const { return at(pos); }
+
+    /**
+     * access the first and the last element.
+     * throw container_is_empty when the container is empty.
+     */
+    value_type front() const {
+        if (!map.total_size)
+            throw container_is_empty("front function: container is empty");
+        block* blk = map.front();
+        return blk->get(blk->head);
+    }
+    value_type back() const {
+        if (!map.total_size)
+            throw container_is_empty("back function: container is empty");
+        block* blk = map.back();
+        return blk->get(blk->head + blk->size - 1);
+    }
+
+    /**
+     * iterators.
+     */
+    iterator begin() { return iterator(this, 0); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator cbegin() const { return const_iterator(this, 0); }
+    iterator end() { return iterator(this, map.total_size); }
+    const_iterator end() const { return const_iterator(this, map.total_size); }
+    const_iterator cend() const { return const_iterator(this, map.total_size); }
+
+    /**
+     * size.
+     */
+    bool empty() const { return !map.total_size; }
+    size_t size() const { return map.total_size; }
+    /**
+     * bytes held for the elements: the blocks and the map.
+     */
+    size_t memory_bytes() const {
+        return map.blocks * sizeof(block) + map.memory_bytes();
+    }
+    /**
+     * the number of true elements, a word at a time.
+     */
+    size_t count() const {
+        static_assert(Bits == 1, "count function: only for bits");
+        size_t ret = 0;
+        for (size_t k = 0; k < map.blocks; k++) {
+            block* blk = map.block_at(k);
+            ret += blk->popcount(blk->head, blk->size);
+        }
+        return ret;
+    }
+
+    /**
+     * clear all contents.
+     */
+    void clear() { map.free_blocks(); }
+
+    /**
+     * push and pop at both ends.
+     * throw runtime_error if value does not fit in Bits,
+     * container_is_empty when popping an empty container.
+     */
+    void push_back(value_type value) {
+        check(value);
+        size_t slot;
+        map.open_back(slot)->set(slot, value);
+    }
+    void push_front(value_type value) {
+        check(value);
+        size_t slot;
+        map.open_front(slot)->set(slot, value);
+    }
+    void pop_back() {
+        if (!map.total_size)
+            throw container_is_empty("pop_back function: container is empty");
+        map.close_back();
+    }
+    void pop_front() {
+        if (!map.total_size)
+            throw container_is_empty("pop_front function: container is empty");
+        map.close_front();
+    }
+
+    /**
+     * insert value before pos and return an iterator to it.
+     * a full block is split in two first.
+     * throw index_out_of_bound if pos is out of bound, runtime_error if
+     * value does not fit in Bits.
+     */
+    iterator insert(const size_t& pos, value_type value) {
+        if (pos > map.total_size)
+            throw index_out_of_bound("insert function: index out of bound");
+        check(value);
+        size_t slot;
+        map.open_slot(pos, slot)->set(slot, value);
+        return iterator(this, pos);
+    }
+    iterator insert(const_iterator pos, value_type value) {
+        if (pos.check_ptr != this)
+            throw invalid_iterator("insert function: invalid iterator");
+        return insert(pos.pos, value);
+    }
+    /**
+     * remove the element at pos and return an iterator to the following
+     * one. a block left with under a quarter of its room is merged into
+     * a neighbour when both fit in half a block.
+     * throw index_out_of_bound if pos is out of bound.
+     */
+    iterator erase(const size_t& pos) {
+        if (pos >= map.total_size)
+            throw index_out_of_bound("erase function: index out of bound");
+        size_t k, j;
+        map.locate(pos, k, j);
+        map.close_slot(k, j);
+        return iterator(this, pos);
+    }
+    iterator erase(const_iterator pos) {
+        if (pos.check_ptr != this)
+            throw invalid_iterator("erase function: invalid iterator");
+        return erase(pos.pos);
+    }
+
+    //------------------------------
+    // blocks
+    //------------------------------
+    static uint64_t check(value_type value) {
+        if ((uint64_t)value > mask)
+            throw runtime_error("bit_deque: value too wide");
+        return value;
+    }
+    // the element in a slot, for the iterators
+    reference element(block* blk, size_t slot) {
+        return reference(blk, slot);
+    }
+    value_type element(block* blk, size_t slot) const {
+        return blk->get(slot);
+    }
+};
+}  // namespace sjtu
+
+#endif
@@ -0,0 +1,588 @@
+#ifndef SJTU_BLOCK_MAP_HPP
+#define SJTU_BLOCK_MAP_HPP
+#include "exceptions.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+namespace sjtu {
+/**
+ * the map of blocks shared by spill_deque, packed_deque, soa_deque and
+ * bit_deque: an array of block pointers with free room on both sides,
+ * so a block is added at either end in O(1) amortized.
+ * it does not own the blocks; the container frees them.
+ */
+template <class Block>
+class block_map {
+   public:
+    // the blocks in order: table[table_head, table_head + blocks)
+    std::vector<Block*> table;
+    size_t table_head = 0;
+    size_t blocks = 0;
+
+   public:
+    Block* block_at(size_t k) const { return table[table_head + k]; }
+    Block* front() const { return block_at(0); }
+    Block* back() const { return block_at(blocks - 1); }
+    /**
+     * bytes held by the table.
+     */
+    size_t memory_bytes() const { return table.size() * sizeof(Block*); }
+
+    /**
+     * put blk in place k, moving the shorter side of the table, and
+     * growing it when that side has no room left.
+     */
+    void insert_block(size_t k, Block* blk) {
+        bool front = k < blocks / 2;
+        if (front ? !table_head : table_head + blocks == table.size())
+            grow();
+        if (front) {
+            --table_head;
+            for (size_t i = 0; i < k; i++)
+                table[table_head + i] = table[table_head + i + 1];
+        } else {
+            for (size_t i = blocks; i > k; i--)
+                table[table_head + i] = table[table_head + i - 1];
+        }
+        table[table_head + k] = blk;
+        ++blocks;
+    }
+    /**
+     * take block k out, moving the shorter side of the table, and
+     * return it for the caller to free.
+     */
+    Block* remove_block(size_t k) {
+        Block* blk = block_at(k);
+        if (k < blocks / 2) {
+            for (size_t i = k; i > 0; i--)
+                table[table_head + i] = table[table_head + i - 1];
+            ++table_head;
+        } else {
+            for (size_t i = k; i + 1 < blocks; i++)
+                table[table_head + i] = table[table_head + i + 1];
+        }
+        --blocks;
+        if (!blocks)
+            table_head = table.size() / 2;
+        return blk;
+    }
+    // keep room for as many blocks again on each side
+    void grow() {
+        std::vector<Block*> bigger(2 * blocks + 16);
+        size_t new_head = (bigger.size() - blocks) / 2;
+        for (size_t i = 0; i < blocks; i++)
+            bigger[new_head + i] = block_at(i);
+        table.swap(bigger);
+        table_head = new_head;
+    }
+    /**
+     * forget all the blocks, which the caller has freed.
+     */
+    void clear() {
+        table.clear();
+        table_head = blocks = 0;
+    }
+    void swap(block_map& other) noexcept {
+        table.swap(other.table);
+        std::swap(table_head, other.table_head);
+        std::swap(blocks, other.blocks);
+    }
+};
+
+/**
+ * a block_map whose blocks are partly full, for the containers with
+ * insert and erase in the middle, soa_deque and bit_deque. a Block
+ * keeps its elements in slots [head, head + size) of BlockElements, is
+ * built empty from its head and freed with delete once its elements are
+ * gone, and has relocate(dst, from, src) moving the element in slot src
+ * of block from into the raw slot dst.
+ * the open_ functions hand out a raw slot, already counted, for the
+ * caller to build the element in; the close_ functions drop a slot whose
+ * element the caller has destroyed.
+ * pushes and pops at both ends are O(1). insert and erase shift the
+ * smaller half of one block, split it when full, and merge it with its
+ * neighbour when both are small.
+ */
+template <class Block, size_t BlockElements>
+class sized_block_map : public block_map<Block> {
+   public:
+    using block_map<Block>::blocks;
+    using block_map<Block>::block_at;
+    size_t total_size = 0;
+
+   public:
+    // the block and the offset in it of element pos, walking the blocks
+    // from the nearer end; blocks and 0 for the end
+    void locate(size_t pos, size_t& k, size_t& j) const {
+        if (pos >= total_size) {
+            k = blocks, j = 0;
+        } else if (pos < total_size / 2) {
+            for (k = 0; pos >= block_at(k)->size; k++)
+                pos -= block_at(k)->size;
+            j = pos;
+        } else {
+            size_t rest = total_size - pos;
+            for (k = blocks - 1; rest > block_at(k)->size; k--)
+                rest -= block_at(k)->size;
+            j = block_at(k)->size - rest;
+        }
+    }
+
+    Block* open_back(size_t& slot) {
+        Block* blk = blocks ? this->back() : nullptr;
+        if (!blk || blk->head + blk->size == BlockElements) {
+            blk = new Block(0);
+            this->insert_block(blocks, blk);
+        }
+        slot = blk->head + blk->size++;
+        ++total_size;
+        return blk;
+    }
+    Block* open_front(size_t& slot) {
+        Block* blk = blocks ? this->front() : nullptr;
+        if (!blk || !blk->head) {
+            blk = new Block(BlockElements);
+            this->insert_block(0, blk);
+        }
+        slot = --blk->head;
+        ++blk->size;
+        ++total_size;
+        return blk;
+    }
+    // a full block is split in two first
+    Block* open_slot(size_t pos, size_t& slot) {
+        if (pos == 0)
+            return open_front(slot);
+        if (pos == total_size)
+            return open_back(slot);
+        size_t k, j;
+        locate(pos, k, j);
+        if (block_at(k)->size == BlockElements) {
+            split_block(k);
+            if (j >= BlockElements / 2)
+                j -= BlockElements / 2, ++k;
+        }
+        Block* blk = block_at(k);
+        if (blk->head + blk->size == BlockElements ||
+            (blk->head && j < blk->size / 2)) {
+            // shift the front part one slot towards the head
+            for (size_t i = 0; i < j; i++)
+                blk->relocate(blk->head + i - 1, blk, blk->head + i);
+            --blk->head;
+        } else {
+            for (size_t i = blk->size; i > j; i--)
+                blk->relocate(blk->head + i, blk, blk->head + i - 1);
+        }
+        slot = blk->head + j;
+        ++blk->size;
+        ++total_size;
+        return blk;
+    }
+    void close_back() {
+        Block* blk = this->back();
+        --blk->size;
+        --total_size;
+        if (!blk->size)
+            erase_block(blocks - 1);
+    }
+    void close_front() {
+        Block* blk = this->front();
+        ++blk->head;
+        --blk->size;
+        --total_size;
+        if (!blk->size)
+            erase_block(0);
+    }
+    // slot j of block k; a block left with under a quarter of its room is
+    // merged into a neighbour when both fit in half a block
+    void close_slot(size_t k, size_t j) {
+        Block* blk = block_at(k);
+        if (j < blk->size / 2) {
+            for (size_t i = j; i > 0; i--)
+                blk->relocate(blk->head + i, blk, blk->head + i - 1);
+            ++blk->head;
+        } else {
+            for (size_t i = j + 1; i < blk->size; i++)
+                blk->relocate(blk->head + i - 1, blk, blk->head + i);
+        }
+        --blk->size;
+        --total_size;
+        if (!blk->size) {
+            erase_block(k);
+        } else if (4 * blk->size < BlockElements) {
+            if (k + 1 < blocks &&
+                2 * (blk->size + block_at(k + 1)->size) <= BlockElements)
+                merge_blocks(k);
+            else if (k > 0 &&
+                     2 * (blk->size + block_at(k - 1)->size) <= BlockElements)
+                merge_blocks(k - 1);
+        }
+    }
+
+    // free the empty block k
+    void erase_block(size_t k) { delete this->remove_block(k); }
+    // move the second half of the full block k into a new block after it
+    void split_block(size_t k) {
+        Block* blk = block_at(k);
+        Block* next = new Block(0);
+        size_t half = BlockElements / 2;
+        for (size_t i = half; i < blk->size; i++)
+            next->relocate(i - half, blk, blk->head + i);
+        next->size = blk->size - half;
+        blk->size = half;
+        this->insert_block(k + 1, next);
+    }
+    // move the elements of block k + 1 to the end of block k
+    void merge_blocks(size_t k) {
+        Block* blk = block_at(k);
+        Block* next = block_at(k + 1);
+        if (blk->head + blk->size + next->size > BlockElements) {
+            for (size_t i = 0; i < blk->size; i++)
+                blk->relocate(i, blk, blk->head + i);
+            blk->head = 0;
+        }
+        for (size_t i = 0; i < next->size; i++)
+            blk->relocate(blk->head + blk->size + i, next, next->head + i);
+        blk->size += next->size;
+        next->size = 0;
+        erase_block(k + 1);
+    }
+    /**
+     * free all the blocks, whose elements the caller has destroyed.
+     */
+    void free_blocks() {
+        for (size_t k = 0; k < blocks; k++)
+            delete block_at(k);
+        this->clear();
+        total_size = 0;
+    }
+    void swap(sized_block_map& other) noexcept {
+        block_map<Block>::swap(other);
+        std::swap(total_size, other.total_size);
+    }
+};
+
+/**
+ * the iterators of a container whose elements are in a sized_block_map,
+ * its member map. Owner::element(blk, slot) gives the reference to the
+ * element in a slot.
+ * iterators remember their block, so stepping is O(1).
+ * insert and erase invalidate all of them.
+ */
+template <class Owner, bool Const>
+class block_iterator {
+   public:
+    using owner = typename std::conditional<Const, const Owner, Owner>::type;
+    using ref_type =
+        typename std::conditional<Const, typename Owner::const_reference,
+                                  typename Owner::reference>::type;
+    owner* check_ptr;
+    size_t pos;
+    // the block and the offset in it, or blocks and 0 at the end
+    size_t k;
+    size_t j;
+
+   public:
+    block_iterator(owner* ptr = nullptr, size_t pos = 0)
+        : check_ptr(ptr), pos(pos), k(0), j(0) {
+        if (check_ptr)
+            check_ptr->map.locate(pos, k, j);
+    }
+    // iterator to const_iterator
+    template <bool C = Const, class = std::enable_if_t<C>>
+    block_iterator(const block_iterator<Owner, false>& other)
+        : check_ptr(other.check_ptr), pos(other.pos), k(other.k),
+          j(other.j) {}
+
+    block_iterator operator+(const std::ptrdiff_t& n) const {
+        return block_iterator(check_ptr, pos + n);
+    }
+    block_iterator operator-(const std::ptrdiff_t& n) const {
+        return block_iterator(check_ptr, pos - n);
+    }
+    std::ptrdiff_t operator-(const block_iterator& rhs) const {
+        if (check_ptr != rhs.check_ptr)
+            throw invalid_iterator("distance function: not the same list");
+        return (std::ptrdiff_t)pos - (std::ptrdiff_t)rhs.pos;
+    }
+    block_iterator& operator+=(const std::ptrdiff_t& n) {
+        return *this = *this + n;
+    }
+    block_iterator& operator-=(const std::ptrdiff_t& n) {
+        return *this = *this - n;
+    }
+    block_iterator operator++(int) {
+        block_iterator iter = *this;
+        ++*this;
+        return iter;
+    }
+    block_iterator& operator++() {
+        if (!check_ptr || pos >= check_ptr->map.total_size)
+            throw index_out_of_bound("iterator funtion: index out of bound");
+        ++pos;
+        if (++j == check_ptr->map.block_at(k)->size)
+            ++k, j = 0;
+        return *this;
+    }
+    block_iterator operator--(int) {
+        block_iterator iter = *this;
+        --*this;
+        return iter;
+    }
+    block_iterator& operator--() {
+        if (!check_ptr || pos == 0)
+            throw index_out_of_bound("iterator funtion: index out of bound");
+        --pos;
+        if (j == 0)
+            j = check_ptr->map.block_at(--k)->size;
+        --j;
+        return *this;
+    }
+    ref_type operator*() const {
+        if (!check_ptr || pos >= check_ptr->map.total_size)
+            throw invalid_iterator("operator* function: invalid iterator");
+        auto* blk = check_ptr->map.block_at(k);
+        return check_ptr->element(blk, blk->head + j);
+    }
+    bool operator==(const block_iterator& rhs) const {
+        return check_ptr == rhs.check_ptr && pos == rhs.pos;
+    }
+    bool operator!=(const block_iterator& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+/**
+ * the blocks kept in memory in least recently used order, most recent
+ * first, linked through Block::lru_prev and lru_next; Block::in_lru
+ * tells whether a block is in the list.
+ */
+template <class Block>
+class block_lru {
+   public:
+    Block* head = nullptr;
+    Block* tail = nullptr;
+
+   public:
+    void push(Block* blk) {
+        blk->lru_prev = nullptr;
+        blk->lru_next = head;
+        if (head)
+            head->lru_prev = blk;
+        else
+            tail = blk;
+        head = blk;
+        blk->in_lru = true;
+    }
+    void unlink(Block* blk) {
+        (blk->lru_prev ? blk->lru_prev->lru_next : head) = blk->lru_next;
+        (blk->lru_next ? blk->lru_next->lru_prev : tail) = blk->lru_prev;
+        blk->lru_prev = blk->lru_next = nullptr;
+        blk->in_lru = false;
+    }
+    void clear() { head = tail = nullptr; }
+};
+
+/**
+ * a block_map whose blocks are all full but the two ends, for the
+ * containers with no insert or erase in the middle, spill_deque and
+ * packed_deque: element pos is in slot (head + pos) % BlockElements of
+ * block (head + pos) / BlockElements.
+ * the end blocks are always in memory. the interior ones in memory are
+ * kept in lru, and the owner may evict them past its cap and restore
+ * them when read. Owner supplies these steps:
+ * new_block() and free_block(blk) allocate and free a block;
+ * restore(blk) brings an evicted block back, a no-op if it is in memory;
+ * evict(blk) takes an interior block out of memory while over_cap();
+ * written(blk) marks that blk changed in memory.
+ * open_back and open_front hand out the slot for a new end element,
+ * already counted; close_back and close_front drop the end element.
+ */
+template <class Owner, class Block, size_t BlockElements>
+class fixed_block_map : public block_map<Block> {
+   public:
+    using block_map<Block>::blocks;
+    using block_map<Block>::block_at;
+    Owner* owner;
+    // position of the first element in the first block
+    size_t head = 0;
+    size_t total_size = 0;
+    mutable block_lru<Block> lru;
+
+   public:
+    explicit fixed_block_map(Owner* owner) : owner(owner) {}
+
+    // the block and the slot of element pos
+    size_t block_of(size_t pos) const { return (head + pos) / BlockElements; }
+    size_t slot_of(size_t pos) const { return (head + pos) % BlockElements; }
+
+    Block* open_back(size_t& slot) {
+        size_t g = head + total_size;
+        if (g == blocks * BlockElements)
+            add_block(false);
+        slot = g % BlockElements;
+        ++total_size;
+        return block_at(g / BlockElements);
+    }
+    Block* open_front(size_t& slot) {
+        if (!head) {
+            add_block(true);
+            head = BlockElements;
+        }
+        slot = --head;
+        ++total_size;
+        return this->front();
+    }
+    // an emptied end block is freed, and its neighbour restored
+    void close_back() {
+        --total_size;
+        if (!total_size)
+            free_blocks();
+        else if (head + total_size <= (blocks - 1) * BlockElements)
+            drop_block(false);
+    }
+    void close_front() {
+        --total_size;
+        if (!total_size) {
+            free_blocks();
+        } else if (++head == BlockElements) {
+            drop_block(true);
+            head = 0;
+        }
+    }
+
+    /**
+     * block k in memory and most recently used.
+     * only interior blocks in memory are in lru.
+     */
+    Block* touch(size_t k) const {
+        Block* blk = block_at(k);
+        if (blk->in_lru) {
+            lru.unlink(blk);
+        } else if (k == 0 || k + 1 == blocks) {
+            return blk;
+        } else {
+            owner->restore(blk);
+            shrink();
+        }
+        lru.push(blk);
+        return blk;
+    }
+    // evict the least recently used interior blocks past the cap
+    void shrink() const {
+        while (owner->over_cap() && lru.tail) {
+            Block* blk = lru.tail;
+            owner->evict(blk);
+            lru.unlink(blk);
+        }
+    }
+
+    // open a new end block; the old end block becomes interior
+    void add_block(bool front) {
+        Block* blk = owner->new_block();
+        try {
+            this->insert_block(front ? 0 : blocks, blk);
+        } catch (...) {
+            owner->free_block(blk);
+            throw;
+        }
+        if (blocks > 2)
+            lru.push(block_at(front ? 1 : blocks - 2));
+        shrink();
+    }
+    // free an emptied end block; its neighbour becomes the new end,
+    // which is written in place from now on
+    void drop_block(bool front) {
+        owner->free_block(this->remove_block(front ? 0 : blocks - 1));
+        Block* end = front ? this->front() : this->back();
+        if (end->in_lru)
+            lru.unlink(end);
+        owner->restore(end);
+        shrink();
+        owner->written(end);
+    }
+    /**
+     * free all the blocks.
+     */
+    void free_blocks() {
+        for (size_t k = 0; k < blocks; k++)
+            owner->free_block(block_at(k));
+        this->clear();
+        head = total_size = 0;
+        lru.clear();
+    }
+};
+
+/**
+ * a read-only iterator that keeps only its position and reads through
+ * Owner::at(), for containers that find a block in O(1) from a position.
+ */
+template <class Owner>
+class position_iterator {
+   public:
+    using value_type = typename Owner::value_type;
+    const Owner* check_ptr;
+    size_t pos;
+
+   public:
+    position_iterator(const Owner* ptr1 = nullptr, size_t ptr2 = 0)
+        : check_ptr(ptr1), pos(ptr2) {}
+    position_iterator operator+(const std::ptrdiff_t& n) const {
+        return position_iterator(check_ptr, pos + n);
+    }
+    position_iterator operator-(const std::ptrdiff_t& n) const {
+        return position_iterator(check_ptr, pos - n);
+    }
+    std::ptrdiff_t operator-(const position_iterator& rhs) const {
+        if (check_ptr != rhs.check_ptr)
+            throw invalid_iterator("distance function: not the same list");
+        return (std::ptrdiff_t)pos - (std::ptrdiff_t)rhs.pos;
+    }
+    position_iterator& operator+=(const std::ptrdiff_t& n) {
+        pos += n;
+        return *this;
+    }
+    position_iterator& operator-=(const std::ptrdiff_t& n) {
+        pos -= n;
+        return *this;
+    }
+    position_iterator operator++(int) {
+        position_iterator iter = *this;
+        ++*this;
+        return iter;
+    }
+    position_iterator& operator++() {
+        if (!check_ptr || pos >= check_ptr->size())
+            throw index_out_of_bound("iterator funtion: index out of bound");
+        ++pos;
+        return *this;
+    }
+    position_iterator operator--(int) {
+        position_iterator iter = *this;
+        --*this;
+        return iter;
+    }
+    position_iterator& operator--() {
+        if (!check_ptr || pos == 0)
+            throw index_out_of_bound("iterator funtion: index out of bound");
+        --pos;
+        return *this;
+    }
+    const value_type& operator*() const {
+        if (check_ptr && pos < check_ptr->size())
+            return check_ptr->at(pos);
+        throw invalid_iterator("operator* function: invalid iterator");
+    }
+    const value_type* operator->() const { return &**this; }
+    bool operator==(const position_iterator& rhs) const {
+        return check_ptr == rhs.check_ptr && pos == rhs.pos;
+    }
+    bool operator!=(const position_iterator& rhs) const {
+        return !(*this == rhs);
+    }
+};
+}  // namespace sjtu
+
+#endif
@@ -1,14 +1,93 @@
 #ifndef SJTU_DEQUE_HPP
 #define SJTU_DEQUE_HPP
 #define DEFAULT_CAPACITY 128
+#define CACHE_LINE 64
+// emptied blocks a deque keeps around for reuse
+#ifndef SPARE_BLOCKS
+#define SPARE_BLOCKS 4
+#endif
+// a flat deque switches to blocks past this many elements,
+// and a block deque back to flat below a quarter of it
+#ifndef FLAT_CAPACITY
+#define FLAT_CAPACITY 65536
+#endif
+// ... or once middle inserts/erases would relocate more than this many
+// elements per operation on average
+#ifndef FLAT_SHIFT_LIMIT
+#define FLAT_SHIFT_LIMIT 256
+#endif
+// define DEQUE_TRACE to give every deque operation counters and an event
+// hook, see deque_counters; without it they compile to nothing
+#ifdef DEQUE_TRACE
+#define DEQUE_TRACE_DO(stmt) stmt
+#else
+#define DEQUE_TRACE_DO(stmt)
+#endif
+#include "bit_deque.hpp"
 #include "exceptions.hpp"
+#include "serializer.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
-#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 namespace sjtu {
 template <class T>
-class double_list {
+class double_list;
+/**
+ * the sorted shadow of the values of a block, for deque's rank queries.
+ */
+template <class T>
+class rank_shadow {
+   public:
+    std::vector<T*> sorted;
+    bool dirty = true;
+};
+// a block points to its shadow only while the rank index is enabled and
+// the block has been queried; the list of blocks has no room for one
+template <class T>
+class rank_shadow_slot {
+   public:
+    rank_shadow<T>* shadow = nullptr;
+
+    rank_shadow_slot() {}
+    rank_shadow_slot(const rank_shadow_slot&) {}
+    rank_shadow_slot& operator=(const rank_shadow_slot&) {
+        shadow_dirty();
+        return *this;
+    }
+    ~rank_shadow_slot() { delete shadow; }
+    void shadow_dirty() {
+        if (shadow)
+            shadow->dirty = true;
+    }
+    void drop_shadow() {
+        delete shadow;
+        shadow = nullptr;
+    }
+    void swap_shadow(rank_shadow_slot& other) {
+        std::swap(shadow, other.shadow);
+    }
+};
+template <class U>
+class rank_shadow_slot<double_list<U>> {
+   public:
+    void shadow_dirty() {}
+    void drop_shadow() {}
+    void swap_shadow(rank_shadow_slot&) {}
+};
+
+template <class T>
+class double_list : public rank_shadow_slot<T> {
    public:
     class Node {
        public:
@@ -50,22 +129,22 @@ class double_list {
     }
     T& back() {
         if (size == 0)
-            throw std::runtime_error("double_list.back: invalid back");
+            throw container_is_empty("double_list.back: invalid back");
         return *(end_ptr->prev->val_ptr);
     }
     T& front() {
         if (size == 0)
-            throw std::runtime_error("double_list.front: invalid front");
+            throw container_is_empty("double_list.front: invalid front");
         return *(head->val_ptr);
     }
     const T& back() const {
         if (size == 0)
-            throw std::runtime_error("double_list.back: invalid back");
+            throw container_is_empty("double_list.back: invalid back");
         return *(end_ptr->prev->val_ptr);
     }
     const T& front() const {
         if (size == 0)
-            throw std::runtime_error("double_list.front: invalid front");
+            throw container_is_empty("double_list.front: invalid front");
         return *(head->val_ptr);
     }
     class iterator {
@@ -83,7 +162,7 @@ class double_list {
                 ptr = ptr->next;
                 return to_return;
             }
-            throw std::runtime_error("index out of bound");
+            throw index_out_of_bound("index out of bound");
         }
 
         iterator& operator++() {
@@ -91,7 +170,7 @@ class double_list {
                 ptr = ptr->next;
                 return *this;
             }
-            throw std::runtime_error("index out of bound");
+            throw index_out_of_bound("index out of bound");
         }
 
         iterator operator--(int) {
@@ -100,7 +179,7 @@ class double_list {
                 ptr = ptr->prev;
                 return to_return;
             }
-            throw std::runtime_error("index out of bound");
+            throw index_out_of_bound("index out of bound");
         }
 
         iterator& operator--() {
@@ -108,7 +187,7 @@ class double_list {
                 ptr = ptr->prev;
                 return *this;
             }
-            throw std::runtime_error("index out of bound");
+            throw index_out_of_bound("index out of bound");
         }
         /**
          * if the iter didn't point to a value
@@ -118,7 +197,7 @@ class double_list {
             if (ptr && ptr->val_ptr) {
                 return *(ptr->val_ptr);
             }
-            throw std::runtime_error("119:T& operator*()");
+            throw invalid_iterator("operator* function: invalid iterator");
         }
         /**
          * other operation
@@ -150,7 +229,8 @@ class double_list {
      */
     iterator erase(iterator pos) {
         if (pos == iterator() || pos == end())
-            throw std::runtime_error("erase function: pointing to nothing");
+            throw invalid_iterator("erase function: pointing to nothing");
+        this->shadow_dirty();
         if (pos == begin()) {
             delete_head();
             return begin();
@@ -163,8 +243,10 @@ class double_list {
         return iterator(to_return);
     }
 
-    void insert_head(const T& val) {
-        Node* node_ptr = new Node(new T(val));
+    template <class V>
+    void insert_head(V&& val) {
+        this->shadow_dirty();
+        Node* node_ptr = new Node(new T(std::forward<V>(val)));
         if (head == end_ptr) {
             head = node_ptr;
             end_ptr->prev = head;
@@ -176,8 +258,10 @@ class double_list {
         }
         size++;
     }
-    void insert_tail(const T& val) {
-        Node* node_ptr = new Node(new T(val));
+    template <class V>
+    void insert_tail(V&& val) {
+        this->shadow_dirty();
+        Node* node_ptr = new Node(new T(std::forward<V>(val)));
         if (end_ptr != head) {
             end_ptr->prev->next = node_ptr;
             node_ptr->prev = end_ptr->prev;
@@ -193,6 +277,7 @@ class double_list {
     void delete_head() {
         if (head == end_ptr)
             return;
+        this->shadow_dirty();
         Node* to_delete = head;
         head = head->next;
         head->prev = nullptr;
@@ -202,6 +287,7 @@ class double_list {
     void delete_tail() {
         if (head == end_ptr)
             return;
+        this->shadow_dirty();
         Node* to_delete = end_ptr->prev;
         if (to_delete->prev)
             to_delete->prev->next = end_ptr;
@@ -213,6 +299,7 @@ class double_list {
     }
     void clear() {
         Node* current = head;
+        this->drop_shadow();
         Node* to_delete = current;
         while (current != end_ptr) {
             to_delete = current;
@@ -220,6 +307,7 @@ class double_list {
             delete to_delete;
         }
         head = end_ptr = &end_node;
+        end_node.prev = nullptr;
         size = 0;
     }
     /**
@@ -231,18 +319,18 @@ class double_list {
     // newly add
     T& at(const size_t& pos) {
         if (pos >= size)
-            throw std::runtime_error("at function: index_out_of_bound");
+            throw index_out_of_bound("at function: index_out_of_bound");
         Node* _ptr = head;
-        for (int i = 1; i <= pos; i++) {
+        for (size_t i = 1; i <= pos; i++) {
             _ptr = _ptr->next;
         }
         return *(_ptr->val_ptr);
     }
     const T& at(const size_t& pos) const {
         if (pos >= size)
-            throw std::runtime_error("at function: index_out_of_bound");
+            throw index_out_of_bound("at function: index_out_of_bound");
         Node* _ptr = head;
-        for (int i = 1; i <= pos; i++) {
+        for (size_t i = 1; i <= pos; i++) {
             _ptr = _ptr->next;
         }
         return *(_ptr->val_ptr);
@@ -252,7 +340,8 @@ class double_list {
 
     iterator insert(iterator pos, const T& value) {
         if (pos == iterator())
-            throw std::runtime_error("insert function: invalid iterator");
+            throw invalid_iterator("insert function: invalid iterator");
+        this->shadow_dirty();
         Node* new_ptr = new Node(new T(value));
         Node* ori_ptr = pos.ptr;
         if (!ori_ptr->prev)
@@ -266,9 +355,270 @@ class double_list {
         return iterator(new_ptr);
     }
     //--------------------------------
+    // relinking helpers, nodes change lists without copying the values
+    /**
+     * take node out of the list without deleting it.
+     */
+    Node* unlink(Node* node) {
+        if (node == head) {
+            head = node->next;
+            head->prev = nullptr;
+        } else {
+            node->prev->next = node->next;
+            node->next->prev = node->prev;
+        }
+        node->prev = node->next = nullptr;
+        size--;
+        this->shadow_dirty();
+        return node;
+    }
+    /**
+     * link a detached node in front of pos.
+     */
+    iterator link(iterator pos, Node* node) {
+        Node* ori_ptr = pos.ptr;
+        if (ori_ptr == head) {
+            head = node;
+            node->prev = nullptr;
+        } else {
+            ori_ptr->prev->next = node;
+            node->prev = ori_ptr->prev;
+        }
+        node->next = ori_ptr;
+        ori_ptr->prev = node;
+        size++;
+        this->shadow_dirty();
+        return iterator(node);
+    }
+    /**
+     * exchange the nodes of two lists in O(1).
+     * only the links to the embedded end nodes need fixing.
+     */
+    void swap(double_list& other) {
+        std::swap(head, other.head);
+        std::swap(end_node.prev, other.end_node.prev);
+        std::swap(size, other.size);
+        this->swap_shadow(other);
+        for (double_list* lst : {this, &other}) {
+            if (lst->size) {
+                lst->end_node.prev->next = lst->end_ptr;
+            } else {
+                lst->head = lst->end_ptr;
+                lst->end_node.prev = nullptr;
+            }
+        }
+    }
+    /**
+     * move the first count nodes to the tail of dst.
+     */
+    void move_head_to(double_list& dst, size_t count) {
+        if (!count)
+            return;
+        if (count > size)
+            throw index_out_of_bound("move_head_to: index_out_of_bound");
+        Node *first = head, *last = head;
+        for (size_t i = 1; i < count; i++)
+            last = last->next;
+        head = last->next;
+        head->prev = nullptr;
+        size -= count;
+        if (dst.head == dst.end_ptr) {
+            dst.head = first;
+        } else {
+            dst.end_ptr->prev->next = first;
+            first->prev = dst.end_ptr->prev;
+        }
+        last->next = dst.end_ptr;
+        dst.end_ptr->prev = last;
+        dst.size += count;
+        this->shadow_dirty();
+        dst.shadow_dirty();
+    }
+    /**
+     * move the last count nodes to the head of dst.
+     */
+    void move_tail_to(double_list& dst, size_t count) {
+        if (!count)
+            return;
+        if (count > size)
+            throw index_out_of_bound("move_tail_to: index_out_of_bound");
+        Node *last = end_ptr->prev, *first = last;
+        for (size_t i = 1; i < count; i++)
+            first = first->prev;
+        Node* before = first->prev;
+        if (before)
+            before->next = end_ptr;
+        else
+            head = end_ptr;
+        end_ptr->prev = before;
+        size -= count;
+        if (dst.head == dst.end_ptr) {
+            last->next = dst.end_ptr;
+            dst.end_ptr->prev = last;
+        } else {
+            last->next = dst.head;
+            dst.head->prev = last;
+        }
+        first->prev = nullptr;
+        dst.head = first;
+        dst.size += count;
+        this->shadow_dirty();
+        dst.shadow_dirty();
+    }
+    /**
+     * make pos the first node, the nodes before it move to the tail.
+     */
+    void rotate_to(Node* pos) {
+        if (pos == head || pos == end_ptr)
+            return;
+        Node *first = head, *last = end_ptr->prev, *before = pos->prev;
+        head = pos;
+        pos->prev = nullptr;
+        last->next = first;
+        first->prev = last;
+        before->next = end_ptr;
+        end_ptr->prev = before;
+        this->shadow_dirty();
+    }
+};
+/**
+ * raw slots a deque keeps inside the object for its first elements.
+ */
+template <class T, size_t N>
+class inline_buffer {
+   public:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[N];
+    T* inline_data() { return reinterpret_cast<T*>(slots); }
+    const T* inline_data() const { return reinterpret_cast<const T*>(slots); }
 };
 template <class T>
-class deque {
+class inline_buffer<T, 0> {
+   public:
+    T* inline_data() { return nullptr; }
+    const T* inline_data() const { return nullptr; }
+};
+
+/**
+ * block size policies: the least number of elements a block holds,
+ * before sqrt(n) takes over for large deques.
+ * byte_block_policy sizes a block so that its nodes and values add up to
+ * about Bytes, so a block of matrices holds fewer elements than one of ints.
+ */
+template <size_t Bytes>
+class byte_block_policy {
+   public:
+    template <class T>
+    static constexpr size_t block_elements() {
+        size_t n = Bytes / (sizeof(typename double_list<T>::Node) + sizeof(T));
+        return n ? n : 1;
+    }
+};
+using page_block_policy = byte_block_policy<4096>;
+using l1_block_policy = byte_block_policy<32 * 1024>;
+using l2_block_policy = byte_block_policy<256 * 1024>;
+// the old rule, DEFAULT_CAPACITY elements whatever their size
+class count_block_policy {
+   public:
+    template <class T>
+    static constexpr size_t block_elements() {
+        return DEFAULT_CAPACITY;
+    }
+};
+
+/**
+ * checking policies: with checked_access, operator[] is at() and the
+ * iterators throw when stepped past either end or dereferenced at end();
+ * with unchecked_access they do none of that, and misuse is undefined.
+ * at() checks its bound under both.
+ */
+class checked_access {
+   public:
+    static constexpr bool check = true;
+};
+class unchecked_access {
+   public:
+    static constexpr bool check = false;
+};
+
+/**
+ * structural events reported to a deque's trace hook, with the number of
+ * elements involved: the block size for block_alloc/block_free, the
+ * elements moved for the others.
+ */
+enum class deque_event {
+    block_alloc,
+    block_free,
+    block_split,
+    block_merge,
+    ring_resize,
+    spill,
+    collapse
+};
+/**
+ * per deque counters, kept only when DEQUE_TRACE is defined.
+ */
+class deque_counters {
+   public:
+    // blocks split because they grew too large / merged into a neighbour,
+    // and the elements that moved
+    size_t expands = 0, expand_moved = 0;
+    size_t compresses = 0, compress_moved = 0;
+    // nodes and blocks get_step walked back over
+    size_t step_nodes = 0, step_blocks = 0;
+    // nodes and blocks quick_move walked forward over,
+    // the walks done for at() and operator[] included
+    size_t walk_nodes = 0, walk_blocks = 0;
+    size_t at_calls = 0;
+    size_t blocks_allocated = 0, blocks_freed = 0;
+    size_t ring_resizes = 0, spills = 0, collapses = 0;
+};
+using deque_trace_hook = void (*)(void* context, deque_event event,
+                                  size_t elements);
+
+/**
+ * what a deque holds on the heap, see deque::memory_stats().
+ * bytes count sizeof of each allocation, not the allocator's own headers,
+ * and not memory the elements themselves own.
+ */
+class deque_stats {
+   public:
+    bool flat = true;
+    size_t elements = 0;
+    size_t element_bytes = 0;   // the elements
+    size_t overhead_bytes = 0;  // nodes, block headers, unused ring slots
+    size_t blocks = 0;
+    size_t spare_blocks = 0;
+    size_t spare_capacity = 0;  // elements that fit before an allocation
+    // elements per block, all 0 in flat mode
+    size_t block_size = 0;  // the size blocks are split and merged around
+    size_t min_fill = 0;
+    size_t max_fill = 0;
+    double mean_fill = 0;
+    // histogram[i] counts blocks holding i * 2 * block_size / buckets
+    // up to (i + 1) * 2 * block_size / buckets elements,
+    // the last bucket takes anything larger
+    std::vector<size_t> histogram;
+
+    double overhead_per_element() const {
+        return elements ? (double)overhead_bytes / elements : 0;
+    }
+};
+
+/**
+ * a deque with two layouts.
+ * flat mode keeps the elements in one ring buffer: the first InlineN slots
+ * live inside the object, after that the ring moves to the heap and doubles.
+ * block mode is a list of blocks, each a double_list of about sqrt(n)
+ * elements, which makes inserts in the middle cheap.
+ * the deque starts flat, turns into blocks once it grows past FLAT_CAPACITY
+ * or middle inserts/erases get frequent, and turns flat again once it has
+ * shrunk and the middle traffic has died down.
+ */
+template <class T,
+          size_t InlineN = 0,
+          class BlockPolicy = page_block_policy,
+          class CheckPolicy = checked_access>
+class deque : public inline_buffer<T, InlineN> {
    public:
     using list_Node = typename double_list<double_list<T>>::Node;
     using Node = typename double_list<T>::Node;
@@ -277,6 +627,103 @@ class deque {
 
     double_list<double_list<T>> list;
     size_t total_size;
+    // flat mode: the elements sit in ring[(ring_head + i) % ring_cap]
+    // and the block list stays empty
+    bool flat = true;
+    // the elements read back to front, see reverse()
+    bool reversed = false;
+    T* ring = this->inline_data();
+    size_t ring_cap = InlineN;
+    size_t ring_head = 0;
+    // recent operations and how many of them hit the middle,
+    // halved every 1024 operations
+    size_t recent_ops = 0;
+    size_t recent_middle = 0;
+#ifdef DEQUE_TRACE
+    mutable deque_counters counters;
+    deque_trace_hook trace_hook = nullptr;
+    void* trace_context = nullptr;
+    void set_trace_hook(deque_trace_hook hook, void* context = nullptr) {
+        trace_hook = hook;
+        trace_context = context;
+    }
+    void reset_counters() { counters = deque_counters(); }
+    void trace(deque_event event, size_t elements) {
+        if (trace_hook)
+            trace_hook(trace_context, event, elements);
+    }
+    // report every block of the list, before it is freed or after copying
+    void trace_blocks(deque_event event) {
+        for (list_Node* p = list.head; p != list.end_ptr; p = p->next) {
+            event == deque_event::block_free ? ++counters.blocks_freed
+                                             : ++counters.blocks_allocated;
+            trace(event, p->val_ptr->size);
+        }
+    }
+#endif
+
+    // one step through the block list, end() is (list.end_ptr, nullptr)
+    static void step_forward(list_Node*& lst_ptr, Node*& n_ptr) {
+        n_ptr = n_ptr->next;
+        if (!n_ptr->val_ptr) {
+            lst_ptr = lst_ptr->next;
+            n_ptr = lst_ptr->val_ptr ? lst_ptr->val_ptr->head : nullptr;
+        }
+    }
+    static void step_back(list_Node*& lst_ptr, Node*& n_ptr) {
+        if (n_ptr && n_ptr->prev) {
+            n_ptr = n_ptr->prev;
+            return;
+        }
+        lst_ptr = lst_ptr->prev;
+        n_ptr = lst_ptr->val_ptr->end_ptr->prev;
+    }
+    // the same steps in a reversed deque, whose end() is still
+    // (list.end_ptr, nullptr) but stands in front of the first block
+    void step_forward_reversed(list_Node*& lst_ptr, Node*& n_ptr) const {
+        if (n_ptr->prev) {
+            n_ptr = n_ptr->prev;
+        } else if (lst_ptr->prev) {
+            lst_ptr = lst_ptr->prev;
+            n_ptr = lst_ptr->val_ptr->end_ptr->prev;
+        } else {
+            lst_ptr = list.end_ptr;
+            n_ptr = nullptr;
+        }
+    }
+    void step_back_reversed(list_Node*& lst_ptr, Node*& n_ptr) const {
+        if (!n_ptr) {
+            lst_ptr = list.head;
+            n_ptr = lst_ptr->val_ptr->head;
+            return;
+        }
+        n_ptr = n_ptr->next;
+        if (!n_ptr->val_ptr) {
+            lst_ptr = lst_ptr->next;
+            n_ptr = lst_ptr->val_ptr->head;
+        }
+    }
+    // one step towards the back / the front in the order the deque reads
+    void step_next(list_Node*& lst_ptr, Node*& n_ptr) const {
+        if (reversed)
+            step_forward_reversed(lst_ptr, n_ptr);
+        else
+            step_forward(lst_ptr, n_ptr);
+    }
+    void step_prev(list_Node*& lst_ptr, Node*& n_ptr) const {
+        if (reversed)
+            step_back_reversed(lst_ptr, n_ptr);
+        else
+            step_back(lst_ptr, n_ptr);
+    }
+    // whether step_prev can be taken from (lst_ptr, n_ptr)
+    bool has_prev(const list_Node* lst_ptr, const Node* n_ptr) const {
+        if (!reversed)
+            return (n_ptr && n_ptr->prev) || lst_ptr->prev;
+        if (!n_ptr)
+            return total_size;
+        return n_ptr->next->val_ptr || lst_ptr->next->val_ptr;
+    }
 
    public:
     class const_iterator;
@@ -291,12 +738,16 @@ class deque {
         Node* node_ptr;
         // to check if two iterator points to the same list
         deque* check_ptr;
+        // position in the ring, used while the deque is flat
+        size_t index;
 
        public:
-        int get_step() const {
+        std::ptrdiff_t get_step() const {
+            if (!list_ptr)
+                return index;
             Node* ptr1 = this->node_ptr;
             list_Node* ptr2 = this->list_ptr;
-            int step = 0;
+            std::ptrdiff_t step = 0;
             if (ptr2->next) {
                 while (ptr1) {
                     ptr1 = ptr1->prev;
@@ -305,38 +756,51 @@ class deque {
                 while (ptr2 && ptr2->prev) {
                     ptr2 = ptr2->prev;
                     step += ptr2->val_ptr->size;
+                    DEQUE_TRACE_DO(++check_ptr->counters.step_blocks);
                 }
+                DEQUE_TRACE_DO(check_ptr->counters.step_nodes += step);
             }
-            return step == 0 ? check_ptr->total_size : step - 1;
+            // step is one past the position in the list
+            std::ptrdiff_t n = check_ptr->total_size;
+            if (step == 0)
+                return n;
+            return check_ptr->reversed ? n - step : step - 1;
         }
 
-        iterator quick_move(int step) const {
+        iterator quick_move(std::ptrdiff_t step) const {
+            if (step < 0 || (size_t)step > check_ptr->total_size)
+                throw index_out_of_bound("quick move: out of bound");
+            if (check_ptr->flat) {
+                return iterator(nullptr, nullptr, check_ptr, step);
+            }
             if (step == 0) {
                 return check_ptr->begin();
             }
-            if (step == check_ptr->total_size) {
+            if (step == (std::ptrdiff_t)check_ptr->total_size) {
                 return check_ptr->end();
             }
-            size_t _remain = step;
+            size_t _remain = check_ptr->physical(step);
             size_t step_inner;
             list_Node* l_ptr = check_ptr->list.head;
-            for (int i = 0; i < check_ptr->list.size; i++) {
+            for (size_t i = 0; i < check_ptr->list.size; i++) {
                 if (_remain >= l_ptr->val_ptr->size) {
                     _remain -= l_ptr->val_ptr->size;
                     l_ptr = l_ptr->next;
+                    DEQUE_TRACE_DO(++check_ptr->counters.walk_blocks);
                 } else {
                     step_inner = _remain;
                     break;
                 }
             }
             if (!l_ptr->val_ptr)
-                throw std::runtime_error("quick move: out of bound");
+                throw index_out_of_bound("quick move: out of bound");
             Node* n_ptr = l_ptr->val_ptr->head;
-            for (int i = 0; i < step_inner; i++) {
+            for (size_t i = 0; i < step_inner; i++) {
                 if (!n_ptr)
-                    throw std::runtime_error("quick move: out of bound");
+                    throw index_out_of_bound("quick move: out of bound");
                 n_ptr = n_ptr->next;
             }
+            DEQUE_TRACE_DO(check_ptr->counters.walk_nodes += step_inner);
             return iterator(l_ptr, n_ptr, check_ptr);
         }
         /**
@@ -346,14 +810,15 @@ class deque {
          */
         iterator(list_Node* ptr1 = nullptr,
                  Node* ptr2 = nullptr,
-                 deque* ptr3 = nullptr)
-            : list_ptr(ptr1), node_ptr(ptr2), check_ptr(ptr3) {}
-        iterator operator+(const int& n) const {
-            int step = get_step() + n;
+                 deque* ptr3 = nullptr,
+                 size_t ptr4 = 0)
+            : list_ptr(ptr1), node_ptr(ptr2), check_ptr(ptr3), index(ptr4) {}
+        iterator operator+(const std::ptrdiff_t& n) const {
+            std::ptrdiff_t step = get_step() + n;
             return quick_move(step);
         }
-        iterator operator-(const int& n) const {
-            int step = get_step() - n;
+        iterator operator-(const std::ptrdiff_t& n) const {
+            std::ptrdiff_t step = get_step() - n;
             return quick_move(step);
         }
 
@@ -362,22 +827,22 @@ class deque {
          * if they point to different vectors, throw
          * invaild_iterator.
          */
-        int operator-(const iterator& rhs) const {
+        std::ptrdiff_t operator-(const iterator& rhs) const {
             list_Node *_ptr1 = this->list_ptr, *_ptr2 = rhs.list_ptr;
             if (check_ptr != rhs.check_ptr)
-                throw std::runtime_error(
+                throw invalid_iterator(
                     "distance function: not the same list");
-            int step = get_step() - rhs.get_step();
+            std::ptrdiff_t step = get_step() - rhs.get_step();
             return step;
         }
-        iterator& operator+=(const int& n) {
-            int step = get_step() + n;
+        iterator& operator+=(const std::ptrdiff_t& n) {
+            std::ptrdiff_t step = get_step() + n;
             auto iter = quick_move(step);
             *this = iter;
             return *this;
         }
-        iterator& operator-=(const int& n) {
-            int step = get_step() - n;
+        iterator& operator-=(const std::ptrdiff_t& n) {
+            std::ptrdiff_t step = get_step() - n;
             auto iter = quick_move(step);
             *this = iter;
             return *this;
@@ -387,82 +852,89 @@ class deque {
          * iter++
          */
         iterator operator++(int) {
-            if (node_ptr && node_ptr->next && node_ptr->next->val_ptr) {
-                auto iter = iterator(list_ptr, node_ptr, check_ptr);
-                node_ptr = node_ptr->next;
-                return iter;
-            } else if (list_ptr && list_ptr->next) {
-                auto iter = iterator(list_ptr, node_ptr, check_ptr);
-                list_ptr = list_ptr->next;
-                node_ptr =
-                    list_ptr->val_ptr ? list_ptr->val_ptr->head : nullptr;
-                return iter;
-            }
-            throw std::runtime_error("iterator funtion: index out of bound");
+            iterator iter = *this;
+            ++*this;
+            return iter;
         }
         /**
          * ++iter
          */
         iterator& operator++() {
-            if (node_ptr && node_ptr->next && node_ptr->next->val_ptr) {
-                node_ptr = node_ptr->next;
+            if constexpr (!CheckPolicy::check) {
+                if (!list_ptr)
+                    ++index;
+                else
+                    check_ptr->step_next(list_ptr, node_ptr);
                 return *this;
-            } else if (list_ptr && list_ptr->next) {
-                list_ptr = list_ptr->next;
-                node_ptr =
-                    list_ptr->val_ptr ? list_ptr->val_ptr->head : nullptr;
+            }
+            if (!list_ptr) {
+                if (!check_ptr || index >= check_ptr->total_size)
+                    throw index_out_of_bound(
+                        "iterator funtion: index out of bound");
+                ++index;
                 return *this;
             }
-            throw std::runtime_error("iterator funtion: index out of bound");
+            if (!node_ptr)
+                throw index_out_of_bound(
+                    "iterator funtion: index out of bound");
+            check_ptr->step_next(list_ptr, node_ptr);
+            return *this;
         }
         /**
          * iter--
          */
         iterator operator--(int) {
-            if (node_ptr && node_ptr->prev) {
-                auto iter = iterator(list_ptr, node_ptr, check_ptr);
-                node_ptr = node_ptr->prev;
-                return iter;
-            } else if (list_ptr && list_ptr->prev) {
-                auto iter = iterator(list_ptr, node_ptr);
-                list_ptr = list_ptr->prev;
-                node_ptr = list_ptr->val_ptr->end_ptr->prev;
-                // add something maybe
-                return iter;
-            }
-            throw std::runtime_error("iterator funtion: index out of bound");
+            iterator iter = *this;
+            --*this;
+            return iter;
         }
         /**
          * --iter
          */
         iterator& operator--() {
-            if (node_ptr && node_ptr->prev) {
-                node_ptr = node_ptr->prev;
+            if constexpr (!CheckPolicy::check) {
+                if (!list_ptr)
+                    --index;
+                else
+                    check_ptr->step_prev(list_ptr, node_ptr);
+                return *this;
+            }
+            if (!list_ptr) {
+                if (!check_ptr || index == 0)
+                    throw index_out_of_bound(
+                        "iterator funtion: index out of bound");
+                --index;
                 return *this;
-            } else if (list_ptr && list_ptr->prev) {
-                list_ptr = list_ptr->prev;
-                node_ptr = list_ptr->val_ptr->end_ptr->prev;
-                // add something maybe
+            }
+            if (check_ptr->has_prev(list_ptr, node_ptr)) {
+                check_ptr->step_prev(list_ptr, node_ptr);
                 return *this;
             }
-            throw std::runtime_error("iterator funtion: index out of bound");
+            throw index_out_of_bound("iterator funtion: index out of bound");
         }
 
         /**
          * *it
          */
-        T& operator*() const {
-            if (node_ptr && node_ptr->val_ptr)
-                return *(node_ptr->val_ptr);
-            throw std::runtime_error("operator* function: invalid iterator");
-        }
+        T& operator*() const { return *operator->(); }
         /**
          * it->field
+         * the block reached is marked as modified for the rank index.
          */
-        T* operator->() const noexcept {
-            if (node_ptr && node_ptr->val_ptr)
+        T* operator->() const {
+            if constexpr (!CheckPolicy::check) {
+                if (!list_ptr)
+                    return check_ptr->flat_slot(index);
+                list_ptr->val_ptr->shadow_dirty();
+                return node_ptr->val_ptr;
+            }
+            if (!list_ptr && check_ptr && index < check_ptr->total_size)
+                return check_ptr->flat_slot(index);
+            if (list_ptr && node_ptr && node_ptr->val_ptr) {
+                list_ptr->val_ptr->shadow_dirty();
                 return node_ptr->val_ptr;
-            throw std::runtime_error("operator* function: invalid iterator");
+            }
+            throw invalid_iterator("operator* function: invalid iterator");
         }
 
         /**
@@ -471,22 +943,22 @@ class deque {
          */
         bool operator==(const iterator& rhs) const {
             return this->node_ptr == rhs.node_ptr &&
-                   this->list_ptr == rhs.list_ptr;
+                   this->list_ptr == rhs.list_ptr && this->index == rhs.index;
         }
         bool operator==(const const_iterator& rhs) const {
             return this->node_ptr == rhs.node_ptr &&
-                   this->list_ptr == rhs.list_ptr;
+                   this->list_ptr == rhs.list_ptr && this->index == rhs.index;
         }
         /**
          * some other operator for iterators.
          */
         bool operator!=(const iterator& rhs) const {
             return this->node_ptr != rhs.node_ptr ||
-                   this->list_ptr != rhs.list_ptr;
+                   this->list_ptr != rhs.list_ptr || this->index != rhs.index;
         }
         bool operator!=(const const_iterator& rhs) const {
             return this->node_ptr != rhs.node_ptr ||
-                   this->list_ptr != rhs.list_ptr;
+                   this->list_ptr != rhs.list_ptr || this->index != rhs.index;
         }
     };
 
@@ -500,12 +972,15 @@ class deque {
         Node* node_ptr;
         list_Node* list_ptr;
         const deque* check_ptr;
+        size_t index;
 
        public:
-        int get_step() const {
+        std::ptrdiff_t get_step() const {
+            if (!list_ptr)
+                return index;
             Node* ptr1 = this->node_ptr;
             list_Node* ptr2 = this->list_ptr;
-            int step = 0;
+            std::ptrdiff_t step = 0;
             if (ptr2->next) {
                 while (ptr1) {
                     ptr1 = ptr1->prev;
@@ -513,68 +988,82 @@ class deque {
                 }
                 while (ptr2) {
                     ptr2 = ptr2->prev;
-                    if (ptr2)
+                    if (ptr2) {
                         step += ptr2->val_ptr->size;
+                        DEQUE_TRACE_DO(++check_ptr->counters.step_blocks);
+                    }
                 }
+                DEQUE_TRACE_DO(check_ptr->counters.step_nodes += step);
             }
-            return step - 1 == -1 ? check_ptr->total_size : step - 1;
+            std::ptrdiff_t n = check_ptr->total_size;
+            if (step == 0)
+                return n;
+            return check_ptr->reversed ? n - step : step - 1;
         }
 
-        const_iterator quick_move(int step) const {
+        const_iterator quick_move(std::ptrdiff_t step) const {
+            if (step < 0 || (size_t)step > check_ptr->total_size)
+                throw index_out_of_bound("quick move: out of bound");
+            if (check_ptr->flat) {
+                return const_iterator(nullptr, nullptr, check_ptr, step);
+            }
             if (step == 0) {
                 return check_ptr->cbegin();
             }
-            if (step == check_ptr->total_size) {
+            if (step == (std::ptrdiff_t)check_ptr->total_size) {
                 return check_ptr->cend();
             }
-            size_t _remain = step - 1;
+            size_t _remain = check_ptr->physical(step);
             size_t step_inner;
             list_Node* l_ptr = check_ptr->list.head;
-            for (int i = 0; i < check_ptr->list.size; i++) {
+            for (size_t i = 0; i < check_ptr->list.size; i++) {
                 if (_remain >= l_ptr->val_ptr->size) {
                     _remain -= l_ptr->val_ptr->size;
                     l_ptr = l_ptr->next;
+                    DEQUE_TRACE_DO(++check_ptr->counters.walk_blocks);
                 } else {
                     step_inner = _remain;
                     break;
                 }
             }
             Node* n_ptr = l_ptr->val_ptr->head;
-            for (int i = 0; i < step_inner; i++) {
+            for (size_t i = 0; i < step_inner; i++) {
                 if (!n_ptr) {
-                    throw std::runtime_error("quick move: out of bound");
+                    throw index_out_of_bound("quick move: out of bound");
                 }
                 n_ptr = n_ptr->next;
             }
-            return ++const_iterator(l_ptr, n_ptr, check_ptr);
+            DEQUE_TRACE_DO(check_ptr->counters.walk_nodes += step_inner);
+            return const_iterator(l_ptr, n_ptr, check_ptr);
         }
         const_iterator(list_Node* ptr1 = nullptr,
                        Node* ptr2 = nullptr,
-                       const deque* ptr3 = nullptr)
-            : list_ptr(ptr1), node_ptr(ptr2), check_ptr(ptr3) {}
-        const_iterator operator+(const int& n) const {
-            int step = get_step() + n;
+                       const deque* ptr3 = nullptr,
+                       size_t ptr4 = 0)
+            : list_ptr(ptr1), node_ptr(ptr2), check_ptr(ptr3), index(ptr4) {}
+        const_iterator operator+(const std::ptrdiff_t& n) const {
+            std::ptrdiff_t step = get_step() + n;
             return quick_move(step);
         }
-        const_iterator operator-(const int& n) const {
-            int step = get_step() - n;
+        const_iterator operator-(const std::ptrdiff_t& n) const {
+            std::ptrdiff_t step = get_step() - n;
             return quick_move(step);
         }
-        int operator-(const const_iterator& rhs) const {
+        std::ptrdiff_t operator-(const const_iterator& rhs) const {
             if (check_ptr != rhs.check_ptr)
-                throw std::runtime_error(
+                throw invalid_iterator(
                     "distance function: not the same list");
-            int step = this->get_step() - rhs.get_step();
+            std::ptrdiff_t step = this->get_step() - rhs.get_step();
             return step;
         }
-        const_iterator& operator+=(const int& n) {
-            int step = get_step() + n;
+        const_iterator& operator+=(const std::ptrdiff_t& n) {
+            std::ptrdiff_t step = get_step() + n;
             auto iter = quick_move(step);
             *this = iter;
             return *this;
         }
-        const_iterator& operator-=(const int& n) {
-            int step = get_step() - n;
+        const_iterator& operator-=(const std::ptrdiff_t& n) {
+            std::ptrdiff_t step = get_step() - n;
             auto iter = quick_move(step);
             *this = iter;
             return *this;
@@ -583,100 +1072,116 @@ class deque {
          * iter++
          */
         const_iterator operator++(int) {
-            if (node_ptr && node_ptr->next && node_ptr->next->val_ptr) {
-                auto iter = const_iterator(list_ptr, node_ptr, check_ptr);
-                node_ptr = node_ptr->next;
-                return iter;
-            } else if (list_ptr && list_ptr->next && list_ptr->next->val_ptr) {
-                auto iter = const_iterator(list_ptr, node_ptr, check_ptr);
-                list_ptr = list_ptr->next;
-                node_ptr = list_ptr->val_ptr->head;
-                return iter;
-            }
-            throw std::runtime_error("iterator funtion: index out of bound");
+            const_iterator iter = *this;
+            ++*this;
+            return iter;
         }
         /**
          * ++iter
          */
         const_iterator& operator++() {
-            if (node_ptr && node_ptr->next && node_ptr->next->val_ptr) {
-                node_ptr = node_ptr->next;
+            if constexpr (!CheckPolicy::check) {
+                if (!list_ptr)
+                    ++index;
+                else
+                    check_ptr->step_next(list_ptr, node_ptr);
                 return *this;
-            } else if (list_ptr && list_ptr->next && list_ptr->next->val_ptr) {
-                list_ptr = list_ptr->next;
-                node_ptr = list_ptr->val_ptr->head;
+            }
+            if (!list_ptr) {
+                if (!check_ptr || index >= check_ptr->total_size)
+                    throw index_out_of_bound(
+                        "iterator funtion: index out of bound");
+                ++index;
                 return *this;
             }
-            throw std::runtime_error("iterator funtion: index out of bound");
+            if (!node_ptr)
+                throw index_out_of_bound(
+                    "iterator funtion: index out of bound");
+            check_ptr->step_next(list_ptr, node_ptr);
+            return *this;
         }
         /**
          * iter--
          */
         const_iterator operator--(int) {
-            if (node_ptr && node_ptr->prev) {
-                auto iter = const_iterator(list_ptr, node_ptr, check_ptr);
-                node_ptr = node_ptr->prev;
-                return iter;
-            } else if (list_ptr && list_ptr->prev) {
-                auto iter = const_iterator(list_ptr, node_ptr, check_ptr);
-                list_ptr = list_ptr->prev;
-                node_ptr = list_ptr->val_ptr->end_ptr->prev;
-                // add something maybe
-                return iter;
-            }
-            throw std::runtime_error("iterator funtion: index out of bound");
+            const_iterator iter = *this;
+            --*this;
+            return iter;
         }
         /**
          * --iter
          */
         const_iterator& operator--() {
-            if (node_ptr && node_ptr->prev) {
-                node_ptr = node_ptr->prev;
+            if constexpr (!CheckPolicy::check) {
+                if (!list_ptr)
+                    --index;
+                else
+                    check_ptr->step_prev(list_ptr, node_ptr);
+                return *this;
+            }
+            if (!list_ptr) {
+                if (!check_ptr || index == 0)
+                    throw index_out_of_bound(
+                        "iterator funtion: index out of bound");
+                --index;
                 return *this;
-            } else if (list_ptr && list_ptr->prev) {
-                list_ptr = list_ptr->prev;
-                node_ptr = list_ptr->val_ptr->end_ptr->prev;
-                // add something maybe
+            }
+            if (check_ptr->has_prev(list_ptr, node_ptr)) {
+                check_ptr->step_prev(list_ptr, node_ptr);
                 return *this;
             }
-            throw std::runtime_error("iterator funtion: index out of bound");
+            throw index_out_of_bound("iterator funtion: index out of bound");
         }
 
         /**
          * *it
          */
         const T& operator*() const {
+            if constexpr (!CheckPolicy::check) {
+                if (!list_ptr)
+                    return *check_ptr->flat_slot(index);
+                return *node_ptr->val_ptr;
+            }
+            if (!list_ptr && check_ptr && index < check_ptr->total_size)
+                return *check_ptr->flat_slot(index);
             if (node_ptr && node_ptr->val_ptr)
                 return *(node_ptr->val_ptr);
-            throw std::runtime_error("operator* function: invalid iterator");
+            throw invalid_iterator("operator* function: invalid iterator");
         }
         /**
          * it->field
          */
-        const T* operator->() const noexcept {
+        const T* operator->() const {
+            if constexpr (!CheckPolicy::check) {
+                if (!list_ptr)
+                    return check_ptr->flat_slot(index);
+                return node_ptr->val_ptr;
+            }
+            if (!list_ptr && check_ptr && index < check_ptr->total_size)
+                return check_ptr->flat_slot(index);
             if (node_ptr && node_ptr->val_ptr)
                 return node_ptr->val_ptr;
-            throw std::runtime_error("operator* function: invalid iterator");
+            throw invalid_iterator("operator* function: invalid iterator");
         }
 
         bool operator==(const iterator& rhs) const {
             return this->node_ptr == rhs.node_ptr &&
-                   this->list_ptr == rhs.list_ptr;
+                   this->list_ptr == rhs.list_ptr && this->index == rhs.index;
         }
         bool operator==(const const_iterator& rhs) const {
             return this->node_ptr == rhs.node_ptr &&
-                   this->list_ptr == rhs.list_ptr;
+                   this->list_ptr == rhs.list_ptr && this->index == rhs.index;
         }
         /**
          * some other operator for iterators.
          */
         bool operator!=(const iterator& rhs) const {
             return this->node_ptr != rhs.node_ptr ||
-                   this->list_ptr != rhs.list_ptr;
+                   this->list_ptr != rhs.list_ptr || this->index != rhs.index;
         }
         bool operator!=(const const_iterator& rhs) const {
             return this->node_ptr != rhs.node_ptr ||
-                   this->list_ptr != rhs.list_ptr;
+                   this->list_ptr != rhs.list_ptr || this->index != rhs.index;
         }
     };
 
@@ -685,13 +1190,17 @@ class deque {
      * constructors.
      */
     deque() : list(), total_size(0) {}
-    deque(const deque& other)
-        : total_size(other.total_size), list(other.list) {}
+    deque(const deque& other) : list(), total_size(0) { *this = other; }
 
     /**
      * deconstructor.
      */
-    ~deque() {}
+    ~deque() {
+        DEQUE_TRACE_DO(trace_blocks(deque_event::block_free));
+        destroy_ring();
+        release_ring();
+        free_spares();
+    }
 
     /**
      * assignment operator.
@@ -699,9 +1208,26 @@ class deque {
     deque& operator=(const deque& other) {
         if (this == &other)
             return *this;
-        total_size = other.total_size;
+        destroy_ring();
+        total_size = 0;
         last_modified_Size = other.last_modified_Size;
+        DEQUE_TRACE_DO(trace_blocks(deque_event::block_free));
         list = other.list;
+        DEQUE_TRACE_DO(trace_blocks(deque_event::block_alloc));
+        flat = other.flat;
+        reversed = other.reversed;
+        if (flat) {
+            if (ring_cap < other.total_size)
+                grow_ring(other.total_size);
+            for (; total_size < other.total_size; total_size++)
+                new (ring_slot(total_size)) T(*other.ring_slot(total_size));
+        } else {
+            release_ring();
+            total_size = other.total_size;
+        }
+        recent_ops = other.recent_ops;
+        recent_middle = other.recent_middle;
+        rank_index = other.rank_index;
         return *this;
     }
 
@@ -710,29 +1236,87 @@ class deque {
      * throw index_out_of_bound if out of bound.
      */
     T& at(const size_t& pos) {
-        iterator iter = begin();
-        try {
-            iter += pos;
-        } catch (...) {
-            throw std::runtime_error("at function: index_out_of_bound");
-        }
-        if (!iter.node_ptr || !iter.node_ptr->val_ptr)
-            throw std::runtime_error("at function: index_out_of_bound");
-        return *(iter.node_ptr->val_ptr);
+        if (pos >= total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        return unchecked_at(pos);
     }
     const T& at(const size_t& pos) const {
-        const_iterator iter = cbegin();
-        try {
-            iter += pos;
-        } catch (...) {
-            throw std::runtime_error("at function: index_out_of_bound");
+        if (pos >= total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        return unchecked_at(pos);
+    }
+    /**
+     * access a specified element without bound checking.
+     * operator[] is at() under checked_access and this under
+     * unchecked_access.
+     */
+    T& unchecked_at(size_t pos) {
+        DEQUE_TRACE_DO(++counters.at_calls);
+        pos = physical(pos);
+        if (flat)
+            return *ring_slot(pos);
+        list_Node* l_ptr;
+        Node* n_ptr = locate(pos, &l_ptr);
+        l_ptr->val_ptr->shadow_dirty();
+        return *n_ptr->val_ptr;
+    }
+    const T& unchecked_at(size_t pos) const {
+        DEQUE_TRACE_DO(++counters.at_calls);
+        pos = physical(pos);
+        return flat ? *ring_slot(pos) : *locate(pos)->val_ptr;
+    }
+    T& operator[](const size_t& pos) {
+        if constexpr (CheckPolicy::check)
+            return at(pos);
+        return unchecked_at(pos);
+    }
+    const T& operator[](const size_t& pos) const {
+        if constexpr (CheckPolicy::check)
+            return at(pos);
+        return unchecked_at(pos);
+    }
+    /**
+     * the node of element pos in block mode, walking blocks and then
+     * nodes from whichever end is nearer; its block goes to *where if
+     * asked for.
+     */
+    Node* locate(size_t pos, list_Node** where = nullptr) const {
+        list_Node* l_ptr;
+        if (pos < total_size / 2) {
+            l_ptr = list.head;
+            while (pos >= l_ptr->val_ptr->size) {
+                pos -= l_ptr->val_ptr->size;
+                l_ptr = l_ptr->next;
+                DEQUE_TRACE_DO(++counters.walk_blocks);
+            }
+        } else {
+            size_t back = total_size - 1 - pos;
+            l_ptr = list.end_ptr->prev;
+            while (back >= l_ptr->val_ptr->size) {
+                back -= l_ptr->val_ptr->size;
+                l_ptr = l_ptr->prev;
+                DEQUE_TRACE_DO(++counters.walk_blocks);
+            }
+            pos = l_ptr->val_ptr->size - 1 - back;
         }
-        if (!iter.node_ptr || !iter.node_ptr->val_ptr)
-            throw std::runtime_error("at function: index_out_of_bound");
-        return *(iter.node_ptr->val_ptr);
+        if (where)
+            *where = l_ptr;
+        double_list<T>* blk = l_ptr->val_ptr;
+        Node* n_ptr;
+        if (pos < blk->size / 2) {
+            n_ptr = blk->head;
+            for (size_t i = 0; i < pos; i++)
+                n_ptr = n_ptr->next;
+            DEQUE_TRACE_DO(counters.walk_nodes += pos);
+        } else {
+            n_ptr = blk->end_ptr->prev;
+            for (size_t i = blk->size - 1; i > pos; i--)
+                n_ptr = n_ptr->prev;
+            DEQUE_TRACE_DO(counters.walk_nodes += blk->size - 1 - pos);
+        }
+        return n_ptr;
     }
-    T& operator[](const size_t& pos) { return at(pos); }
-    const T& operator[](const size_t& pos) const { return at(pos); }
+
 
     /**
      * access the first element.
@@ -740,8 +1324,8 @@ class deque {
      */
     const T& front() const {
         if (!total_size)
-            throw std::runtime_error("front function: container is empty");
-        return list.front().front();
+            throw container_is_empty("front function: container is empty");
+        return unchecked_front();
     }
     /**
      * access the last element.
@@ -749,29 +1333,46 @@ class deque {
      */
     const T& back() const {
         if (!total_size)
-            throw std::runtime_error("front function: container is empty");
-        return list.back().back();
+            throw container_is_empty("back function: container is empty");
+        return unchecked_back();
     }
 
     /**
      * return an iterator to the beginning.
      */
     iterator begin() {
-        if (total_size)
-            return iterator(list.head, list.head->val_ptr->head, this);
-        return end();
+        if (flat)
+            return iterator(nullptr, nullptr, this, 0);
+        if (!total_size)
+            return end();
+        if (reversed)
+            return iterator(list.end_ptr->prev,
+                            list.end_ptr->prev->val_ptr->end_ptr->prev, this);
+        return iterator(list.head, list.head->val_ptr->head, this);
     }
     const_iterator cbegin() const {
-        if (total_size)
-            return const_iterator(list.head, list.head->val_ptr->head, this);
-        return cend();
+        if (flat)
+            return const_iterator(nullptr, nullptr, this, 0);
+        if (!total_size)
+            return cend();
+        if (reversed)
+            return const_iterator(list.end_ptr->prev,
+                                  list.end_ptr->prev->val_ptr->end_ptr->prev,
+                                  this);
+        return const_iterator(list.head, list.head->val_ptr->head, this);
     }
 
     /**
      * return an iterator to the end.
      */
-    iterator end() { return iterator(list.end_ptr, nullptr, this); }
+    iterator end() {
+        if (flat)
+            return iterator(nullptr, nullptr, this, total_size);
+        return iterator(list.end_ptr, nullptr, this);
+    }
     const_iterator cend() const {
+        if (flat)
+            return const_iterator(nullptr, nullptr, this, total_size);
         return const_iterator(list.end_ptr, nullptr, this);
     }
 
@@ -785,13 +1386,283 @@ class deque {
      */
     size_t size() const { return total_size; }
 
+    /**
+     * make room for n elements, so that pushing at either end up to
+     * size() == n needs no new ring and no new block.
+     * n up to FLAT_CAPACITY is reserved in the ring; beyond that the deque
+     * turns into blocks and keeps enough spare blocks for n elements.
+     * in block mode every element still allocates its own node.
+     */
+    void reserve(size_t n) {
+        if (n <= total_size)
+            return;
+        if (flat && n <= FLAT_CAPACITY) {
+            if (ring_cap < n)
+                grow_ring(n);
+            return;
+        }
+        if (flat)
+            spill();
+        // a split leaves blocks of one block size, tuned for somewhere
+        // between n / 4 and n elements, so count on half of the largest
+        size_t blocks = 2 * n / block_size_for(n / 4) + 1;
+        if (blocks > list.size)
+            stock_blocks(blocks - list.size);
+    }
+    /**
+     * the ring and the spare blocks serve both ends,
+     * so this reserves the same room as reserve().
+     */
+    void reserve_front(size_t n) { reserve(n); }
+    /**
+     * the number of elements the deque can hold before it needs
+     * a bigger ring or a new block.
+     */
+    size_t capacity() const {
+        if (flat)
+            return ring_cap;
+        return total_size + spare_count * block_size_for(last_modified_Size);
+    }
+    size_t front_capacity() const { return capacity(); }
+    /**
+     * give back the reserved room: shrink the ring to size(), or in
+     * block mode merge neighbouring blocks that fit in one and free
+     * the spare blocks.
+     */
+    void shrink_to_fit() {
+        if (flat) {
+            if (ring_cap > total_size)
+                grow_ring(total_size);
+        } else {
+            for (list_Node* p = list.head; p != list.end_ptr;) {
+                list_Node* lst_next = p->next;
+                merge_next(p);
+                if (p->next == lst_next)
+                    p = lst_next;
+            }
+        }
+        free_spares();
+        spare_limit = SPARE_BLOCKS;
+    }
+
+    /**
+     * count the memory the deque uses, in O(number of blocks).
+     * buckets > 0 also fills in a histogram of the block sizes.
+     */
+    deque_stats memory_stats(size_t buckets = 0) const {
+        deque_stats ret;
+        ret.flat = flat;
+        ret.elements = total_size;
+        ret.element_bytes = total_size * sizeof(T);
+        ret.spare_blocks = spare_count;
+        const size_t header = sizeof(list_Node) + sizeof(double_list<T>);
+        ret.overhead_bytes = spare_count * header;
+        if (flat) {
+            if (ring != this->inline_data())
+                ret.overhead_bytes += (ring_cap - total_size) * sizeof(T);
+            ret.spare_capacity = ring_cap - total_size;
+            return ret;
+        }
+        ret.block_size = block_size_for(last_modified_Size);
+        ret.spare_capacity = spare_count * ret.block_size;
+        ret.overhead_bytes += total_size * sizeof(Node);
+        ret.histogram.assign(buckets, 0);
+        ret.min_fill = total_size;
+        for (list_Node* p = list.head; p != list.end_ptr; p = p->next) {
+            size_t fill = p->val_ptr->size;
+            ++ret.blocks;
+            ret.overhead_bytes +=
+                header + shadow_bytes(p->val_ptr);
+            ret.min_fill = std::min(ret.min_fill, fill);
+            ret.max_fill = std::max(ret.max_fill, fill);
+            if (buckets)
+                ++ret.histogram[std::min(
+                    fill * buckets / (2 * ret.block_size), buckets - 1)];
+        }
+        if (ret.blocks)
+            ret.mean_fill = (double)total_size / ret.blocks;
+        else
+            ret.min_fill = 0;
+        return ret;
+    }
+
     /**
      * clear all contents.
      */
     void clear() {
+        destroy_ring();
         total_size = 0;
+        reversed = false;
         last_modified_Size = DEFAULT_CAPACITY;
+        DEQUE_TRACE_DO(trace_blocks(deque_event::block_free));
         list.clear();
+        flat = true;
+    }
+    //------------------------------
+    // flat mode helpers
+    //------------------------------
+    T* ring_slot(size_t pos) const {
+        size_t idx = ring_head + pos;
+        return ring + (idx >= ring_cap ? idx - ring_cap : idx);
+    }
+    // the slot of the element at pos in the order the deque reads
+    T* flat_slot(size_t pos) const { return ring_slot(physical(pos)); }
+    // move the value from src into the raw slot dst
+    static void relocate(T* dst, T* src) {
+        new (dst) T(std::move(*src));
+        src->~T();
+    }
+    void destroy_ring() {
+        if (flat) {
+            for (size_t i = 0; i < total_size; i++)
+                ring_slot(i)->~T();
+        }
+        ring_head = 0;
+    }
+    void release_ring() {
+        if (ring != this->inline_data())
+            ::operator delete(ring, std::align_val_t(ring_align));
+        ring = this->inline_data();
+        ring_cap = InlineN;
+        ring_head = 0;
+    }
+    bool in_ring(const T* ptr) const {
+        return ptr >= ring && ptr < ring + ring_cap;
+    }
+    /**
+     * move the ring to new_cap slots: the inline slots if they are enough,
+     * a heap buffer aligned to a cache line otherwise.
+     * new_cap may be smaller than ring_cap, but not than total_size.
+     */
+    static constexpr size_t ring_align =
+        alignof(T) > CACHE_LINE ? alignof(T) : CACHE_LINE;
+    void grow_ring(size_t new_cap) {
+        if (!grow_ring(new_cap, std::nothrow))
+            throw std::bad_alloc();
+    }
+    // the same, but return false and leave the ring alone
+    // if the buffer cannot be allocated
+    bool grow_ring(size_t new_cap, const std::nothrow_t&) {
+        T* buf = new_cap <= InlineN
+                     ? this->inline_data()
+                     : static_cast<T*>(::operator new(
+                           new_cap * sizeof(T), std::align_val_t(ring_align),
+                           std::nothrow));
+        if (!buf && new_cap)
+            return false;
+        if (buf == ring)
+            return true;
+        DEQUE_TRACE_DO(++counters.ring_resizes);
+        DEQUE_TRACE_DO(trace(deque_event::ring_resize, total_size));
+        for (size_t i = 0; i < total_size; i++)
+            relocate(buf + i, ring_slot(i));
+        release_ring();
+        ring = buf;
+        ring_cap = std::max(new_cap, InlineN);
+        return true;
+    }
+    /**
+     * make room for one more element in a full ring: double it,
+     * or switch to blocks once it would pass FLAT_CAPACITY.
+     */
+    void make_room() {
+        if (total_size >= FLAT_CAPACITY)
+            spill();
+        else
+            grow_ring(std::min(std::max(2 * ring_cap, (size_t)16),
+                               (size_t)FLAT_CAPACITY));
+    }
+    //------------------------------
+    // layout choice
+    //------------------------------
+    void note_op(bool middle) {
+        if (++recent_ops > 1024) {
+            recent_ops /= 2;
+            recent_middle /= 2;
+        }
+        if (middle)
+            ++recent_middle;
+    }
+    // elements a ring would relocate for the recent middle operations
+    size_t middle_cost() const { return recent_middle * (total_size / 4); }
+    bool prefer_blocks() const {
+        return recent_middle >= 16 &&
+               middle_cost() > FLAT_SHIFT_LIMIT * recent_ops;
+    }
+    bool prefer_flat() const {
+        return 4 * total_size <= FLAT_CAPACITY &&
+               2 * middle_cost() <= FLAT_SHIFT_LIMIT * recent_ops;
+    }
+    /**
+     * move the elements out of the ring into the block list.
+     */
+    void spill() {
+        size_t ring_size = total_size;
+        DEQUE_TRACE_DO(++counters.spills);
+        DEQUE_TRACE_DO(trace(deque_event::spill, ring_size));
+        flat = false;
+        total_size = 0;
+        for (size_t i = 0; i < ring_size; i++) {
+            T* val = ring_slot(i);
+            if (!list.size)
+                list.link(list.end(), take_block());
+            list.back().insert_tail(std::move(*val));
+            val->~T();
+            ++total_size;
+            expand(list.end_ptr->prev);
+        }
+        release_ring();
+    }
+    /**
+     * move the elements out of the block list into a ring.
+     * if the ring cannot be allocated the deque stays in block mode,
+     * so that pops never throw.
+     */
+    void collapse() {
+        size_t list_size = total_size;
+        total_size = 0;
+        if (ring_cap < list_size &&
+            !grow_ring(std::max(2 * list_size, (size_t)16), std::nothrow)) {
+            total_size = list_size;
+            return;
+        }
+        DEQUE_TRACE_DO(++counters.collapses);
+        DEQUE_TRACE_DO(trace(deque_event::collapse, list_size));
+        for (list_Node* p = list.head; p != list.end_ptr; p = p->next) {
+            for (Node* n_ptr = p->val_ptr->head; n_ptr != p->val_ptr->end_ptr;
+                 n_ptr = n_ptr->next) {
+                new (ring_slot(total_size)) T(std::move(*n_ptr->val_ptr));
+                ++total_size;
+            }
+        }
+        DEQUE_TRACE_DO(trace_blocks(deque_event::block_free));
+        list.clear();
+        flat = true;
+    }
+    // insert value before ring position idx
+    void flat_insert(size_t idx, const T& value) {
+        if (idx < total_size / 2) {
+            ring_head = ring_slot(ring_cap - 1) - ring;
+            for (size_t i = 0; i < idx; i++)
+                relocate(ring_slot(i), ring_slot(i + 1));
+        } else {
+            for (size_t i = total_size; i > idx; i--)
+                relocate(ring_slot(i), ring_slot(i - 1));
+        }
+        new (ring_slot(idx)) T(value);
+        ++total_size;
+    }
+    void flat_erase(size_t idx) {
+        ring_slot(idx)->~T();
+        if (idx < total_size / 2) {
+            for (size_t i = idx; i > 0; i--)
+                relocate(ring_slot(i), ring_slot(i - 1));
+            ring_head = ring_slot(1) - ring;
+        } else {
+            for (size_t i = idx; i + 1 < total_size; i++)
+                relocate(ring_slot(i), ring_slot(i + 1));
+        }
+        --total_size;
     }
     //------------------------------
     // assist function
@@ -799,13 +1670,18 @@ class deque {
     //
     //
     //------------------------------
-    static size_t last_modified_Size;
-    int get_BlockSize() {
+    // size the blocks were last tuned for, kept per deque
+    size_t last_modified_Size = DEFAULT_CAPACITY;
+    size_t get_BlockSize() {
         if (total_size > 4 * last_modified_Size ||
             4 * total_size < last_modified_Size) {
             last_modified_Size = total_size;
         }
-        return std::max((int)sqrt(last_modified_Size), DEFAULT_CAPACITY);
+        return block_size_for(last_modified_Size);
+    }
+    static size_t block_size_for(size_t n) {
+        return std::max((size_t)sqrt(n),
+                        BlockPolicy::template block_elements<T>());
     }
     void compress(list_Node* lst_ptr) {
         if (!lst_ptr || lst_ptr == list.end_ptr)
@@ -813,19 +1689,17 @@ class deque {
         list_Node *lst_prev = lst_ptr->prev, *lst_next = lst_ptr->next;
         if (lst_prev && lst_prev->val_ptr->size + lst_ptr->val_ptr->size <=
                             get_BlockSize()) {
-            while (!lst_prev->val_ptr->empty()) {
-                lst_ptr->val_ptr->insert_head(lst_prev->val_ptr->back());
-                lst_prev->val_ptr->delete_tail();
-            }
-            list.erase(list_iterator(lst_prev));
+            DEQUE_TRACE_DO(merged(lst_prev->val_ptr->size));
+            lst_prev->val_ptr->move_tail_to(*lst_ptr->val_ptr,
+                                            lst_prev->val_ptr->size);
+            drop_block(lst_prev);
         } else if (lst_next->val_ptr &&
                    lst_next->val_ptr->size + lst_ptr->val_ptr->size <=
                        get_BlockSize()) {
-            while (!lst_next->val_ptr->empty()) {
-                lst_ptr->val_ptr->insert_tail(lst_next->val_ptr->front());
-                lst_next->val_ptr->delete_head();
-            }
-            list.erase(list_iterator(lst_next));
+            DEQUE_TRACE_DO(merged(lst_next->val_ptr->size));
+            lst_next->val_ptr->move_head_to(*lst_ptr->val_ptr,
+                                            lst_next->val_ptr->size);
+            drop_block(lst_next);
         }
         // std::cout << "compress function deployed" << std::endl;
     }
@@ -835,27 +1709,82 @@ class deque {
             return;
         if (lst_ptr->val_ptr->size < 2 * get_BlockSize())
             return;
-        if (lst_ptr->prev) {
-            list_iterator iter =
-                list.insert(list_iterator(lst_ptr), double_list<T>());
-            list_Node* add_ptr = iter.ptr;
-            size_t divide_blockSize = lst_ptr->val_ptr->size / 2;
-            for (int i = 1; i <= divide_blockSize; i++) {
-                add_ptr->val_ptr->insert_tail(lst_ptr->val_ptr->front());
-                lst_ptr->val_ptr->delete_head();
-            }
-            return;
-        }
-        // otherwise, it's the head_node
-        list.insert_head(double_list<T>());
-        list_Node* add_ptr = list.head;
+        // the front half moves into a new block in front of lst_ptr
+        list_Node* add_ptr = take_block();
+        list.link(list_iterator(lst_ptr), add_ptr);
         size_t divide_blockSize = lst_ptr->val_ptr->size / 2;
-        for (int i = 1; i <= divide_blockSize; i++) {
-            add_ptr->val_ptr->insert_tail(lst_ptr->val_ptr->front());
-            lst_ptr->val_ptr->delete_head();
+        lst_ptr->val_ptr->move_head_to(*add_ptr->val_ptr, divide_blockSize);
+        DEQUE_TRACE_DO(++counters.expands);
+        DEQUE_TRACE_DO(counters.expand_moved += divide_blockSize);
+        DEQUE_TRACE_DO(trace(deque_event::block_split, divide_blockSize));
+    }
+#ifdef DEQUE_TRACE
+    void merged(size_t moved) {
+        ++counters.compresses;
+        counters.compress_moved += moved;
+        trace(deque_event::block_merge, moved);
+    }
+#endif
+    //------------------------------
+    // block recycling
+    // emptied blocks are kept, up to spare_limit of them, and handed out
+    // again before a new block is allocated, so a deque that keeps
+    // splitting and merging blocks at the same place does not allocate.
+    // reserve() raises spare_limit, shrink_to_fit() puts it back.
+    //------------------------------
+    list_Node* spare_head = nullptr;  // chained through next
+    size_t spare_count = 0;
+    size_t spare_limit = SPARE_BLOCKS;
+    list_Node* take_block() {
+        if (!spare_head) {
+            DEQUE_TRACE_DO(++counters.blocks_allocated);
+            DEQUE_TRACE_DO(trace(deque_event::block_alloc, 0));
+            return new list_Node(new double_list<T>());
+        }
+        list_Node* lst_ptr = spare_head;
+        spare_head = lst_ptr->next;
+        lst_ptr->next = nullptr;
+        --spare_count;
+        return lst_ptr;
+    }
+    /**
+     * unlink an emptied block and keep it as a spare.
+     * return the block after it.
+     */
+    list_iterator drop_block(list_Node* lst_ptr) {
+        list_Node* lst_next = lst_ptr->next;
+        list.unlink(lst_ptr);
+        lst_ptr->val_ptr->clear();
+        if (spare_count < spare_limit) {
+            lst_ptr->next = spare_head;
+            spare_head = lst_ptr;
+            ++spare_count;
+        } else {
+            DEQUE_TRACE_DO(++counters.blocks_freed);
+            DEQUE_TRACE_DO(trace(deque_event::block_free, 0));
+            delete lst_ptr;
+        }
+        return list_iterator(lst_next);
+    }
+    void free_spares() {
+        while (spare_head) {
+            list_Node* lst_ptr = spare_head;
+            spare_head = lst_ptr->next;
+            DEQUE_TRACE_DO(++counters.blocks_freed);
+            DEQUE_TRACE_DO(trace(deque_event::block_free, 0));
+            delete lst_ptr;
+        }
+        spare_count = 0;
+    }
+    void stock_blocks(size_t count) {
+        spare_limit = std::max(spare_limit, count);
+        for (; spare_count < count; ++spare_count) {
+            DEQUE_TRACE_DO(++counters.blocks_allocated);
+            DEQUE_TRACE_DO(trace(deque_event::block_alloc, 0));
+            list_Node* lst_ptr = new list_Node(new double_list<T>());
+            lst_ptr->next = spare_head;
+            spare_head = lst_ptr;
         }
-        return;
-        // std::cout << "expand funtion deployed" << std::endl;
     }
 
     /**
@@ -864,16 +1793,40 @@ class deque {
      * throw if the iterator is invalid or it points to a wrong place.
      */
     iterator insert(iterator pos, const T& value) {
-        if (pos.check_ptr != this)
-            throw std::runtime_error(
+        if (pos.check_ptr != this || flat != !pos.list_ptr)
+            throw invalid_iterator(
                 "insert function: not pointing to the same list");
+        if (flat) {
+            size_t idx = pos.index;
+            if (idx > total_size)
+                throw invalid_iterator("insert function: invalid iterator");
+            if (in_ring(&value)) {
+                T tmp(value);
+                return insert(pos, tmp);
+            }
+            note_op(idx != 0 && idx != total_size);
+            if (prefer_blocks())
+                spill();
+            else if (total_size == ring_cap)
+                make_room();
+            if (flat) {
+                // in a reversed ring the value goes after the element
+                // at physical(idx), which is before total_size - idx
+                flat_insert(reversed ? total_size - idx : idx, value);
+                return iterator(nullptr, nullptr, this, idx);
+            }
+            pos = begin() + idx;
+        } else {
+            note_op(pos != begin() && pos != end());
+        }
         if (pos == end()) {
             push_back(value);
             return --end();
         }
         list_Node* lst_ptr = pos.list_ptr;
         Node* nde_ptr = pos.node_ptr;
-        Node_iterator iter = Node_iterator(nde_ptr);
+        // reversed, the value goes after nde_ptr in the block
+        Node_iterator iter = Node_iterator(reversed ? nde_ptr->next : nde_ptr);
         Node_iterator _ret = lst_ptr->val_ptr->insert(iter, value);
         ++total_size;
         Node* _target_ptr = _ret.ptr;
@@ -884,7 +1837,7 @@ class deque {
         }
         expand(lst_ptr);
         iterator _iter = iterator(lst_ptr, _target_ptr, this);
-        return _iter - _step;
+        return reversed ? _iter + _step : _iter - _step;
     }
 
     /**
@@ -894,13 +1847,45 @@ class deque {
      * the iterator is invalid, or it points to a wrong place.
      */
     iterator erase(iterator pos) {
-        if (pos.check_ptr != this)
-            throw std::runtime_error(
+        if (pos.check_ptr != this || flat != !pos.list_ptr)
+            throw invalid_iterator(
                 "erase function: not pointing to the same list");
-        if (list.empty())
-            throw std::runtime_error("erase function: empty container");
+        if (!total_size)
+            throw container_is_empty("erase function: empty container");
         if (pos == end())
-            throw std::runtime_error("erase funciton: erase end");
+            throw invalid_iterator("erase funciton: erase end");
+        if (flat) {
+            size_t idx = pos.index;
+            if (idx >= total_size)
+                throw invalid_iterator("erase funciton: erase end");
+            note_op(idx != 0 && idx != total_size - 1);
+            if (!prefer_blocks()) {
+                flat_erase(physical(idx));
+                return iterator(nullptr, nullptr, this, idx);
+            }
+            spill();
+            pos = begin() + idx;
+        } else {
+            note_op(pos != begin() && pos != --end());
+        }
+        if (reversed) {
+            // block_erase answers the element after pos in the list,
+            // which here is the one before it
+            size_t idx = pos.get_step();
+            block_erase(pos);
+            if (prefer_flat())
+                collapse();
+            return begin() + idx;
+        }
+        iterator ret = block_erase(pos);
+        if (prefer_flat()) {
+            size_t idx = ret.get_step();
+            collapse();
+            return iterator(nullptr, nullptr, this, idx);
+        }
+        return ret;
+    }
+    iterator block_erase(iterator pos) {
         list_Node* lst_ptr = pos.list_ptr;
         Node* nde_ptr = pos.node_ptr;
         Node_iterator iter = Node_iterator(nde_ptr);
@@ -908,7 +1893,7 @@ class deque {
         total_size--;
         // todo
         if (lst_ptr->val_ptr->size == 0) {
-            list_iterator _it = list.erase(lst_ptr);
+            list_iterator _it = drop_block(lst_ptr);
             if (_it == list.end())
                 return end();
             return iterator(_it.ptr, _it.ptr->val_ptr->head, this);
@@ -926,10 +1911,36 @@ class deque {
      * add an element to the end.
      */
     void push_back(const T& value) {
-        if (!list.size) {
-            list.insert_tail(double_list<T>());
+        if (reversed)
+            push_head(value);
+        else
+            push_tail(value);
+    }
+    void push_back(T&& value) {
+        if (reversed)
+            push_head(std::move(value));
+        else
+            push_tail(std::move(value));
+    }
+    // push after the last slot of the ring or node of the block list
+    template <class V>
+    void push_tail(V&& value) {
+        if (flat && total_size == ring_cap && in_ring(&value)) {
+            T tmp(std::forward<V>(value));
+            push_tail(std::move(tmp));
+            return;
+        }
+        note_op(false);
+        if (flat && total_size == ring_cap)
+            make_room();
+        if (flat) {
+            new (ring_slot(total_size)) T(std::forward<V>(value));
+            ++total_size;
+            return;
         }
-        list.back().insert_tail(value);
+        if (!list.size)
+            list.link(list.end(), take_block());
+        list.back().insert_tail(std::forward<V>(value));
         ++total_size;
         expand(list.end_ptr->prev);
     }
@@ -940,45 +1951,951 @@ class deque {
      */
     void pop_back() {
         if (!total_size)
-            throw std::runtime_error("cannot pop_back");
+            throw container_is_empty("cannot pop_back");
+        unchecked_pop_back();
+    }
+    void unchecked_pop_back() {
+        if (reversed)
+            pop_head();
+        else
+            pop_tail();
+    }
+    void pop_tail() {
+        note_op(false);
+        if (flat) {
+            ring_slot(--total_size)->~T();
+            return;
+        }
         list.back().delete_tail();
         --total_size;
         if (list.back().size == 0) {
-            list.erase(--list.end());
+            drop_block(list.end_ptr->prev);
         } else {
             compress(list.end_ptr->prev);
         }
+        if (prefer_flat())
+            collapse();
     }
 
     /**
      * insert an element to the beginning.
      */
     void push_front(const T& value) {
+        if (reversed)
+            push_tail(value);
+        else
+            push_head(value);
+    }
+    void push_front(T&& value) {
+        if (reversed)
+            push_tail(std::move(value));
+        else
+            push_head(std::move(value));
+    }
+    template <class V>
+    void push_head(V&& value) {
+        if (flat && total_size == ring_cap && in_ring(&value)) {
+            T tmp(std::forward<V>(value));
+            push_head(std::move(tmp));
+            return;
+        }
+        note_op(false);
+        if (flat && total_size == ring_cap)
+            make_room();
+        if (flat) {
+            new (ring_slot(ring_cap - 1)) T(std::forward<V>(value));
+            ring_head = ring_slot(ring_cap - 1) - ring;
+            ++total_size;
+            return;
+        }
         if (!list.size)
-            list.insert_tail(double_list<T>());
-        list.front().insert_head(value);
+            list.link(list.end(), take_block());
+        list.front().insert_head(std::forward<V>(value));
         ++total_size;
         expand(list.head);
     }
 
+    /**
+     * add the elements of [first, last) to the end, in order.
+     * the ring is grown once for all of them; past FLAT_CAPACITY the tail
+     * block is filled up and new blocks are linked already filled to the
+     * block size for the final size, with no per-element split.
+     * the elements are moved out of the range, which is left holding
+     * moved-from values; pass const iterators to copy them instead.
+     * the range must not point into this deque.
+     */
+    template <class ForwardIt>
+    void append(ForwardIt first, ForwardIt last) {
+        size_t n = std::distance(first, last);
+        if (!n)
+            return;
+        note_op(false);
+        // a reversed deque takes them at its head, in the reverse order
+        if (flat && total_size + n <= FLAT_CAPACITY) {
+            if (ring_cap < total_size + n)
+                grow_ring(std::max(total_size + n, 2 * ring_cap));
+            for (; first != last; ++first) {
+                if (reversed) {
+                    ring_head = ring_slot(ring_cap - 1) - ring;
+                    new (ring_slot(0)) T(std::move(*first));
+                } else {
+                    new (ring_slot(total_size)) T(std::move(*first));
+                }
+                ++total_size;
+            }
+            return;
+        }
+        if (flat)
+            spill();
+        size_t block_size = block_size_for(total_size + n);
+        while (first != last) {
+            if (!list.size ||
+                (reversed ? list.front() : list.back()).size >= block_size)
+                list.link(reversed ? list.begin() : list.end(), take_block());
+            double_list<T>& blk = reversed ? list.front() : list.back();
+            for (; first != last && blk.size < block_size; ++first) {
+                blk.link(reversed ? blk.begin() : blk.end(),
+                         new Node(new T(std::move(*first))));
+                ++total_size;
+            }
+        }
+    }
+
+    /**
+     * replace the contents with the elements of v, leaving v empty.
+     * up to FLAT_CAPACITY elements are moved into a ring of exactly that
+     * size in one pass, a single memcpy for trivially copyable T; more are
+     * moved into full blocks with append.
+     * the buffer of v itself is freed, not kept: the ring has its own
+     * alignment and the blocks hold one node an element.
+     */
+    void adopt(std::vector<T>&& v) {
+        size_t n = v.size();
+        deque tmp;
+        if (n <= FLAT_CAPACITY) {
+            tmp.grow_ring(n);
+            if constexpr (std::is_trivially_copyable<T>::value) {
+                if (n)
+                    std::memcpy(tmp.ring, v.data(), n * sizeof(T));
+                tmp.total_size = n;
+            } else {
+                for (; tmp.total_size < n; ++tmp.total_size)
+                    new (tmp.ring + tmp.total_size)
+                        T(std::move(v[tmp.total_size]));
+            }
+        } else {
+            tmp.append(v.begin(), v.end());
+        }
+        swap_contents(tmp);
+        std::vector<T>().swap(v);
+    }
+    /**
+     * move the elements out into a vector, in order, leaving the deque
+     * empty. a flat deque is copied out as the two runs of its ring,
+     * each a single memcpy for trivially copyable T, and its ring freed.
+     */
+    std::vector<T> into_vector() {
+        std::vector<T> ret;
+        ret.reserve(total_size);
+        if (flat) {
+            T* first = ring_slot(0);
+            size_t run = std::min(total_size, ring_cap - ring_head);
+            ret.insert(ret.end(), std::make_move_iterator(first),
+                       std::make_move_iterator(first + run));
+            ret.insert(ret.end(), std::make_move_iterator(ring),
+                       std::make_move_iterator(ring + (total_size - run)));
+        } else {
+            for (list_Node* p = list.head; p != list.end_ptr; p = p->next)
+                for (Node* n_ptr = p->val_ptr->head;
+                     n_ptr != p->val_ptr->end_ptr; n_ptr = n_ptr->next)
+                    ret.push_back(std::move(*n_ptr->val_ptr));
+        }
+        if (reversed)
+            std::reverse(ret.begin(), ret.end());
+        clear();
+        release_ring();
+        return ret;
+    }
+
     /**
      * remove the first element.
      * throw when the container is empty.
      */
     void pop_front() {
-        if (list.empty())
-            throw std::runtime_error("pop_front function: container is empty.");
+        if (!total_size)
+            throw container_is_empty("pop_front function: container is empty.");
+        unchecked_pop_front();
+    }
+    void unchecked_pop_front() {
+        if (reversed)
+            pop_tail();
+        else
+            pop_head();
+    }
+    void pop_head() {
+        note_op(false);
+        if (flat) {
+            ring_slot(0)->~T();
+            ring_head = ring_slot(1) - ring;
+            --total_size;
+            return;
+        }
         list.front().delete_head();
         --total_size;
         if (list.front().size == 0) {
-            list.erase(list.begin());
+            drop_block(list.head);
         } else {
             compress(list.head);
         }
+        if (prefer_flat())
+            collapse();
+    }
+
+    //------------------------------
+    // non-throwing access
+    // an empty deque or a bad index is reported through the return value,
+    // none of these has a throw site. they are noexcept as long as moving
+    // or copying a T is.
+    //------------------------------
+    static constexpr bool nothrow_copy =
+        std::is_nothrow_copy_constructible<T>::value;
+    static constexpr bool nothrow_move =
+        std::is_nothrow_move_constructible<T>::value &&
+        std::is_nothrow_move_assignable<T>::value;
+    T& unchecked_front() {
+        touch_end(!reversed);
+        return reversed ? *last_value() : *first_value();
+    }
+    const T& unchecked_front() const {
+        return reversed ? *last_value() : *first_value();
+    }
+    T& unchecked_back() {
+        touch_end(reversed);
+        return reversed ? *first_value() : *last_value();
+    }
+    // the first or last block is about to be written through a reference
+    void touch_end(bool first) {
+        if (!flat)
+            (first ? list.head : list.end_ptr->prev)->val_ptr->shadow_dirty();
+    }
+    const T& unchecked_back() const {
+        return reversed ? *first_value() : *last_value();
+    }
+    // the values at the two ends of the ring or the block list
+    T* first_value() const {
+        return flat ? ring_slot(0) : list.head->val_ptr->head->val_ptr;
+    }
+    T* last_value() const {
+        return flat ? ring_slot(total_size - 1)
+                    : list.end_ptr->prev->val_ptr->end_ptr->prev->val_ptr;
+    }
+    /**
+     * move the first element into out and remove it.
+     * return false, leaving out alone, if the deque is empty.
+     */
+    bool try_pop_front(T& out) noexcept(nothrow_move) {
+        if (!total_size)
+            return false;
+        out = std::move(unchecked_front());
+        unchecked_pop_front();
+        return true;
+    }
+    bool try_pop_back(T& out) noexcept(nothrow_move) {
+        if (!total_size)
+            return false;
+        out = std::move(unchecked_back());
+        unchecked_pop_back();
+        return true;
+    }
+    bool try_pop_front() noexcept(nothrow_move) {
+        if (!total_size)
+            return false;
+        unchecked_pop_front();
+        return true;
+    }
+    bool try_pop_back() noexcept(nothrow_move) {
+        if (!total_size)
+            return false;
+        unchecked_pop_back();
+        return true;
+    }
+    /**
+     * a copy of the first / last / pos-th element,
+     * or std::nullopt if there is none.
+     */
+    std::optional<T> try_front() const noexcept(nothrow_copy) {
+        if (!total_size)
+            return std::nullopt;
+        return unchecked_front();
+    }
+    std::optional<T> try_back() const noexcept(nothrow_copy) {
+        if (!total_size)
+            return std::nullopt;
+        return unchecked_back();
+    }
+    std::optional<T> try_at(size_t pos) const noexcept(nothrow_copy) {
+        if (pos >= total_size)
+            return std::nullopt;
+        return unchecked_at(pos);
+    }
+
+    //------------------------------
+    // moving elements between deques
+    //------------------------------
+    /**
+     * exchange the contents of two deques.
+     * O(1), except that elements held in the inline slots are relocated.
+     * trace counters and hooks stay with their deque.
+     */
+    void swap(deque& other) {
+        if (this == &other)
+            return;
+        swap_contents(other);
+        std::swap(spare_head, other.spare_head);
+        std::swap(spare_count, other.spare_count);
+        std::swap(spare_limit, other.spare_limit);
+        std::swap(rank_index, other.rank_index);
+    }
+    // exchange the elements and their layout but keep the settings:
+    // the rank index and the spare blocks stay with their deque
+    void swap_contents(deque& other) {
+        bool heap = ring != this->inline_data();
+        bool other_heap = other.ring != other.inline_data();
+        if (heap && other_heap) {
+            std::swap(ring, other.ring);
+            std::swap(ring_cap, other.ring_cap);
+            std::swap(ring_head, other.ring_head);
+        } else if (heap) {
+            hand_over_ring(other);
+        } else if (other_heap) {
+            other.hand_over_ring(*this);
+        } else {
+            inline_buffer<T, InlineN> tmp;
+            size_t count = flat ? total_size : 0;
+            size_t other_count = other.flat ? other.total_size : 0;
+            for (size_t i = 0; i < count; i++)
+                relocate(tmp.inline_data() + i, ring_slot(i));
+            for (size_t i = 0; i < other_count; i++)
+                relocate(this->inline_data() + i, other.ring_slot(i));
+            for (size_t i = 0; i < count; i++)
+                relocate(other.inline_data() + i, tmp.inline_data() + i);
+            ring_head = other.ring_head = 0;
+        }
+        list.swap(other.list);
+        std::swap(total_size, other.total_size);
+        std::swap(flat, other.flat);
+        std::swap(reversed, other.reversed);
+        std::swap(recent_ops, other.recent_ops);
+        std::swap(recent_middle, other.recent_middle);
+        std::swap(last_modified_Size, other.last_modified_Size);
+    }
+    // give the heap ring to other, whose ring is its inline slots,
+    // and take other's inline elements into our own inline slots
+    void hand_over_ring(deque& other) {
+        size_t other_count = other.flat ? other.total_size : 0;
+        for (size_t i = 0; i < other_count; i++)
+            relocate(this->inline_data() + i, other.ring_slot(i));
+        other.ring = ring;
+        other.ring_cap = ring_cap;
+        other.ring_head = ring_head;
+        ring = this->inline_data();
+        ring_cap = InlineN;
+        ring_head = 0;
+    }
+    /**
+     * move the first n elements to the back of other, in order.
+     * whole blocks are relinked and the block holding the boundary is
+     * split, so in block mode no element is copied or moved and the cost
+     * is O(blocks); a flat other is first spilled into blocks, which costs
+     * O(other.size()). below one block, while this deque is flat, or when
+     * only one of the two deques is reversed, the elements are moved one
+     * by one instead.
+     * neither deque turns back into a ring here, even if it is small
+     * enough; that is left to its next pop or erase.
+     * iterators to the moved elements are invalidated.
+     * throw index_out_of_bound if n > size().
+     */
+    void transfer_front(deque& other, size_t n) {
+        if (n > total_size)
+            throw index_out_of_bound("transfer_front: index_out_of_bound");
+        if (this == &other) {
+            rotate(n);
+            return;
+        }
+        if (!n)
+            return;
+        if (!other.total_size)
+            other.reversed = reversed;
+        if (flat || n < get_BlockSize() || reversed != other.reversed) {
+            for (size_t i = 0; i < n; i++) {
+                other.push_back(std::move(unchecked_front()));
+                unchecked_pop_front();
+            }
+            return;
+        }
+        // both reversed, the front is the tail of the list on both sides
+        if (reversed)
+            relink_tail(other, n);
+        else
+            relink_head(other, n);
+    }
+    /**
+     * move the last n elements to the front of other, in order.
+     * the mirror image of transfer_front.
+     */
+    void transfer_back(deque& other, size_t n) {
+        if (n > total_size)
+            throw index_out_of_bound("transfer_back: index_out_of_bound");
+        if (this == &other) {
+            rotate(total_size - n);
+            return;
+        }
+        if (!n)
+            return;
+        if (!other.total_size)
+            other.reversed = reversed;
+        if (flat || n < get_BlockSize() || reversed != other.reversed) {
+            for (size_t i = 0; i < n; i++) {
+                other.push_front(std::move(unchecked_back()));
+                unchecked_pop_back();
+            }
+            return;
+        }
+        if (reversed)
+            relink_head(other, n);
+        else
+            relink_tail(other, n);
+    }
+    // move the first n elements of the block list to the tail of other's
+    void relink_head(deque& other, size_t n) {
+        if (other.flat)
+            other.spill();
+        // the first block linked into other, next to its old end
+        list_Node* junction = nullptr;
+        size_t moved = 0;
+        while (moved < n && n - moved >= list.head->val_ptr->size) {
+            list_Node* lst_ptr = list.head;
+            moved += lst_ptr->val_ptr->size;
+            list.unlink(lst_ptr);
+            other.list.link(other.list.end(), lst_ptr);
+            if (!junction)
+                junction = lst_ptr;
+        }
+        if (moved < n) {
+            list_Node* lst_ptr = other.take_block();
+            list.head->val_ptr->move_head_to(*lst_ptr->val_ptr, n - moved);
+            other.list.link(other.list.end(), lst_ptr);
+            if (!junction)
+                junction = lst_ptr;
+        }
+        total_size -= n;
+        other.total_size += n;
+        other.compress(junction);
+        other.compress(other.list.end_ptr->prev);
+        compress(list.head);
+    }
+    // move the last n elements of the block list to the head of other's
+    void relink_tail(deque& other, size_t n) {
+        if (other.flat)
+            other.spill();
+        // the first block linked into other, next to its old front
+        list_Node* junction = nullptr;
+        size_t moved = 0;
+        while (moved < n &&
+               n - moved >= list.end_ptr->prev->val_ptr->size) {
+            list_Node* lst_ptr = list.end_ptr->prev;
+            moved += lst_ptr->val_ptr->size;
+            list.unlink(lst_ptr);
+            other.list.link(other.list.begin(), lst_ptr);
+            if (!junction)
+                junction = lst_ptr;
+        }
+        if (moved < n) {
+            list_Node* lst_ptr = other.take_block();
+            list.end_ptr->prev->val_ptr->move_tail_to(*lst_ptr->val_ptr,
+                                                      n - moved);
+            other.list.link(other.list.begin(), lst_ptr);
+            if (!junction)
+                junction = lst_ptr;
+        }
+        total_size -= n;
+        other.total_size += n;
+        other.compress(junction);
+        other.compress(other.list.head);
+        if (list.size)
+            compress(list.end_ptr->prev);
+    }
+
+    //------------------------------
+    // snapshots
+    // a snapshot is a header, a block table and the block payloads:
+    //     u32 magic, u32 version, u32 element bytes (0 unless raw),
+    //     u32 payload alignment, u64 elements, u64 blocks,
+    //     u64 elements of each block,
+    //     zero bytes up to a multiple of the payload alignment,
+    //     the elements of each block in order.
+    // the padding lets a mapped snapshot be read in place, see
+    // mapped_deque. version 1 had neither and 0 for the alignment.
+    // raw elements are written byte for byte, a whole block at a time,
+    // others go through serializer<T>. integers are in host byte order,
+    // a snapshot from a host of the other order fails the magic check.
+    //------------------------------
+    static constexpr uint32_t snapshot_magic = 0x51454453;  // "SDEQ"
+    static constexpr uint32_t snapshot_version = 2;
+    static constexpr size_t snapshot_header = 4 * sizeof(uint32_t) + 16;
+    // where the payload starts after a table of blocks entries
+    static size_t snapshot_offset(size_t blocks, uint32_t align) {
+        size_t offset = snapshot_header + blocks * sizeof(uint64_t);
+        if (align > 1)
+            offset = (offset + align - 1) / align * align;
+        return offset;
+    }
+    /**
+     * write a snapshot of the deque to os.
+     * throw runtime_error if the stream fails.
+     */
+    void save(std::ostream& os) const {
+        using S = serializer<T>;
+        // the ring is at most two runs, each block is one
+        std::vector<size_t> table;
+        if (flat) {
+            size_t first = std::min(total_size, ring_cap - ring_head);
+            if (first)
+                table.push_back(first);
+            if (total_size > first)
+                table.push_back(total_size - first);
+        } else {
+            for (list_Node* p = list.head; p != list.end_ptr; p = p->next)
+                table.push_back(p->val_ptr->size);
+        }
+        // a reversed deque is written back to front
+        if (reversed)
+            std::reverse(table.begin(), table.end());
+        uint32_t header[4] = {snapshot_magic, snapshot_version,
+                              S::raw ? (uint32_t)sizeof(T) : 0,
+                              (uint32_t)alignof(T)};
+        write_raw(os, header, sizeof(header));
+        write_u64(os, total_size);
+        write_u64(os, table.size());
+        for (size_t count : table)
+            write_u64(os, count);
+        std::string padding(snapshot_offset(table.size(), alignof(T)) -
+                                snapshot_offset(table.size(), 0),
+                            '\0');
+        write_raw(os, padding.data(), padding.size());
+        if (flat && !reversed) {
+            for (size_t i = 0, pos = 0; i < table.size(); pos += table[i++]) {
+                if constexpr (S::raw) {
+                    write_raw(os, ring_slot(pos), table[i] * sizeof(T));
+                } else {
+                    for (size_t j = 0; j < table[i]; j++)
+                        S::write(os, *ring_slot(pos + j));
+                }
+            }
+            return;
+        }
+        // a block's nodes are scattered, and a reversed run is read
+        // backwards, gather them to write each run once
+        std::vector<unsigned char> staging;
+        auto put = [&](const T* val) {
+            if constexpr (S::raw) {
+                size_t at = staging.size();
+                staging.resize(at + sizeof(T));
+                std::memcpy(staging.data() + at, val, sizeof(T));
+            } else {
+                S::write(os, *val);
+            }
+        };
+        auto flush = [&] {
+            if constexpr (S::raw)
+                write_raw(os, staging.data(), staging.size());
+            staging.clear();
+        };
+        if (flat) {
+            for (size_t i = 0; i < total_size; i++)
+                put(flat_slot(i));
+            flush();
+            return;
+        }
+        for (list_Node* p = reversed ? list.end_ptr->prev : list.head;
+             p && p != list.end_ptr; p = reversed ? p->prev : p->next) {
+            double_list<T>* blk = p->val_ptr;
+            if (reversed) {
+                for (Node* n_ptr = blk->end_ptr->prev; n_ptr;
+                     n_ptr = n_ptr->prev)
+                    put(n_ptr->val_ptr);
+            } else {
+                for (Node* n_ptr = blk->head; n_ptr != blk->end_ptr;
+                     n_ptr = n_ptr->next)
+                    put(n_ptr->val_ptr);
+            }
+            flush();
+        }
+    }
+    void save(const char* path) const {
+        std::ofstream os(path, std::ios::binary | std::ios::trunc);
+        if (!os)
+            throw runtime_error("save function: cannot open file");
+        save(os);
+        if (!os.flush())
+            throw runtime_error("save function: write failed");
+    }
+    /**
+     * replace the contents with a snapshot read from is.
+     * the layout is rebuilt for the new size: a ring up to FLAT_CAPACITY,
+     * balanced blocks beyond, whatever the blocks of the saved deque were.
+     * throw runtime_error on a bad or truncated snapshot, or one of
+     * another element type; the deque is left unchanged then.
+     * the element type is only checked by size: a raw snapshot loads into
+     * any raw type of the same sizeof, and serialized ones are not
+     * checked at all beyond what serializer<T>::read notices.
+     * the rank index and the spare blocks stay as they were.
+     */
+    void load(std::istream& is) {
+        using S = serializer<T>;
+        uint32_t header[4];
+        read_raw(is, header, sizeof(header));
+        if (header[0] != snapshot_magic || header[1] == 0 ||
+            header[1] > snapshot_version)
+            throw runtime_error("load function: not a deque snapshot");
+        if (header[2] != (S::raw ? sizeof(T) : 0))
+            throw runtime_error("load function: element type mismatch");
+        size_t n = read_u64(is), table_size = read_u64(is), sum = 0;
+        for (size_t i = 0; i < table_size; i++)
+            sum += read_u64(is);
+        if (sum != n)
+            throw runtime_error("load function: bad block table");
+        size_t padding = snapshot_offset(table_size, header[3]) -
+                         snapshot_offset(table_size, 0);
+        if (padding && (size_t)is.ignore(padding).gcount() != padding)
+            throw runtime_error("snapshot: truncated input");
+        deque tmp;
+        if (n <= FLAT_CAPACITY) {
+            tmp.grow_ring(n);
+            if constexpr (S::raw) {
+                read_raw(is, tmp.ring, n * sizeof(T));
+                tmp.total_size = n;
+            } else {
+                for (; tmp.total_size < n; ++tmp.total_size)
+                    new (tmp.ring + tmp.total_size) T(S::read(is));
+            }
+            swap_contents(tmp);
+            return;
+        }
+        tmp.flat = false;
+        tmp.last_modified_Size = n;
+        size_t blocks = (n + block_size_for(n) - 1) / block_size_for(n);
+        std::vector<unsigned char> staging;
+        for (size_t b = 0; b < blocks; b++) {
+            // the first n % blocks blocks take one element more
+            size_t count = n / blocks + (b < n % blocks);
+            list_Node* lst_ptr = tmp.take_block();
+            tmp.list.link(tmp.list.end(), lst_ptr);
+            double_list<T>* blk = lst_ptr->val_ptr;
+            if constexpr (S::raw) {
+                staging.resize(count * sizeof(T));
+                read_raw(is, staging.data(), staging.size());
+                typename std::aligned_storage<sizeof(T), alignof(T)>::type val;
+                for (size_t i = 0; i < count; i++) {
+                    std::memcpy(&val, staging.data() + i * sizeof(T),
+                                sizeof(T));
+                    blk->link(blk->end(),
+                              new Node(new T(*reinterpret_cast<T*>(&val))));
+                }
+            } else {
+                for (size_t i = 0; i < count; i++)
+                    blk->link(blk->end(), new Node(new T(S::read(is))));
+            }
+            tmp.total_size += count;
+        }
+        swap_contents(tmp);
+    }
+    void load(const char* path) {
+        std::ifstream is(path, std::ios::binary);
+        if (!is)
+            throw runtime_error("load function: cannot open file");
+        load(is);
+    }
+
+    /**
+     * reverse the order of the elements in O(1).
+     * nothing is moved: the deque only starts reading its ring or block
+     * list from the other end, see physical(). the iterators, the ends and
+     * positional access all follow the direction flag, and the layout code
+     * below them works on the list as it lies. iterators are invalidated.
+     */
+    void reverse() { reversed = !reversed; }
+    // where the element at pos lies in the ring or the block list
+    size_t physical(size_t pos) const {
+        return reversed ? total_size - 1 - pos : pos;
+    }
+
+    /**
+     * rotate to the left by k: the element at position k becomes the front.
+     * only the block holding position k is split, the blocks in front of it
+     * are relinked to the tail in O(1).
+     */
+    void rotate(size_t k) {
+        if (!total_size)
+            return;
+        k %= total_size;
+        if (!k)
+            return;
+        // rotating the list right by k rotates its reverse left by k
+        if (reversed)
+            k = total_size - k;
+        if (flat) {
+            flat_rotate(k);
+            return;
+        }
+        list_Node* lst_ptr = list.head;
+        while (k >= lst_ptr->val_ptr->size) {
+            k -= lst_ptr->val_ptr->size;
+            lst_ptr = lst_ptr->next;
+        }
+        if (k) {
+            list_Node* add_ptr = take_block();
+            list.link(list_iterator(lst_ptr), add_ptr);
+            lst_ptr->val_ptr->move_head_to(*add_ptr->val_ptr, k);
+            DEQUE_TRACE_DO(trace(deque_event::block_split, k));
+        }
+        list.rotate_to(lst_ptr);
+        // glue the pieces of the split block back onto their neighbours
+        merge_next(list.end_ptr->prev->prev);
+        merge_next(list.head);
+    }
+    /**
+     * a full ring rotates by moving its head, otherwise the shorter side
+     * is relocated one element at a time through the free slots.
+     */
+    void flat_rotate(size_t k) {
+        if (total_size == ring_cap) {
+            ring_head = (ring_head + k) % ring_cap;
+        } else if (k <= total_size / 2) {
+            for (size_t i = 0; i < k; i++) {
+                relocate(ring_slot(total_size), ring_slot(0));
+                ring_head = ring_slot(1) - ring;
+            }
+        } else {
+            for (size_t i = k; i < total_size; i++) {
+                relocate(ring_slot(ring_cap - 1), ring_slot(total_size - 1));
+                ring_head = ring_slot(ring_cap - 1) - ring;
+            }
+        }
+    }
+    /**
+     * append the block after lst_ptr onto it if both fit in one block.
+     */
+    void merge_next(list_Node* lst_ptr) {
+        if (!lst_ptr || lst_ptr == list.end_ptr)
+            return;
+        list_Node* lst_next = lst_ptr->next;
+        if (lst_next == list.end_ptr ||
+            lst_ptr->val_ptr->size + lst_next->val_ptr->size >
+                get_BlockSize())
+            return;
+        DEQUE_TRACE_DO(merged(lst_next->val_ptr->size));
+        lst_next->val_ptr->move_head_to(*lst_ptr->val_ptr,
+                                        lst_next->val_ptr->size);
+        drop_block(lst_next);
+    }
+
+    //------------------------------
+    // rank queries
+    // with the rank index enabled, every block keeps a sorted shadow of
+    // its values, rebuilt lazily after the block is modified, so that
+    // count_less costs O(sqrt(n) log n) and kth_smallest O(sqrt(n) log^2 n).
+    // without it, both fall back to a plain scan of the range.
+    // a write through at(), operator[], front(), back() or an iterator
+    // marks the block it reaches as modified. a reference kept and
+    // written later is not seen until touch_rank_index() is called.
+    //------------------------------
+    bool rank_index = false;
+    void enable_rank_index() { rank_index = true; }
+    void disable_rank_index() {
+        rank_index = false;
+        for (list_Node* p = list.head; p != list.end_ptr; p = p->next)
+            p->val_ptr->drop_shadow();
+    }
+    void touch_rank_index() {
+        for (list_Node* p = list.head; p != list.end_ptr; p = p->next)
+            p->val_ptr->shadow_dirty();
+    }
+    static bool value_less(const T* a, const T* b) { return *a < *b; }
+    const std::vector<T*>& sorted_block(list_Node* lst_ptr) const {
+        double_list<T>* blk = lst_ptr->val_ptr;
+        if (!blk->shadow)
+            blk->shadow = new rank_shadow<T>;
+        rank_shadow<T>* shadow = blk->shadow;
+        if (shadow->dirty) {
+            shadow->sorted.clear();
+            for (Node* p = blk->head; p != blk->end_ptr; p = p->next)
+                shadow->sorted.push_back(p->val_ptr);
+            std::sort(shadow->sorted.begin(), shadow->sorted.end(),
+                      value_less);
+            shadow->dirty = false;
+        }
+        return shadow->sorted;
+    }
+    static size_t shadow_bytes(const double_list<T>* blk) {
+        return blk->shadow ? sizeof(rank_shadow<T>) +
+                                 blk->shadow->sorted.capacity() * sizeof(T*)
+                           : 0;
+    }
+    /**
+     * split [l, r) into the loose elements of partially covered blocks
+     * and the blocks that lie completely inside the range.
+     */
+    void split_range(size_t l,
+                     size_t r,
+                     std::vector<T*>& loose,
+                     std::vector<list_Node*>& whole) const {
+        if (l > r || r > total_size)
+            throw index_out_of_bound("rank query: index_out_of_bound");
+        if (reversed) {
+            std::swap(l, r);
+            l = total_size - l;
+            r = total_size - r;
+        }
+        if (flat) {
+            for (size_t i = l; i < r; i++)
+                loose.push_back(ring_slot(i));
+            return;
+        }
+        size_t base = 0;
+        for (list_Node* p = list.head; p != list.end_ptr && base < r;
+             p = p->next) {
+            size_t blk_size = p->val_ptr->size;
+            if (base + blk_size > l) {
+                if (rank_index && base >= l && base + blk_size <= r) {
+                    whole.push_back(p);
+                } else {
+                    Node* n_ptr = p->val_ptr->head;
+                    for (size_t i = base; i < base + blk_size && i < r;
+                         ++i, n_ptr = n_ptr->next) {
+                        if (i >= l)
+                            loose.push_back(n_ptr->val_ptr);
+                    }
+                }
+            }
+            base += blk_size;
+        }
+    }
+    /**
+     * return how many elements in positions [l, r) are less than x.
+     */
+    size_t count_less(size_t l, size_t r, const T& x) const {
+        std::vector<T*> loose;
+        std::vector<list_Node*> whole;
+        split_range(l, r, loose, whole);
+        size_t cnt = 0;
+        for (T* val : loose)
+            if (*val < x)
+                ++cnt;
+        for (list_Node* p : whole) {
+            const std::vector<T*>& s = sorted_block(p);
+            cnt += std::lower_bound(s.begin(), s.end(), &x, value_less) -
+                   s.begin();
+        }
+        return cnt;
+    }
+    /**
+     * return the k-th smallest element in positions [l, r), k counts from 0.
+     * the sorted runs are narrowed around the weighted median of their
+     * medians, which drops at least a quarter of the candidates per round.
+     */
+    const T& kth_smallest(size_t l, size_t r, size_t k) const {
+        std::vector<T*> loose;
+        std::vector<list_Node*> whole;
+        split_range(l, r, loose, whole);
+        if (k >= r - l)
+            throw index_out_of_bound("kth_smallest: index_out_of_bound");
+        if (whole.empty()) {
+            std::nth_element(loose.begin(), loose.begin() + k, loose.end(),
+                             value_less);
+            return *loose[k];
+        }
+        std::sort(loose.begin(), loose.end(), value_less);
+        struct run {
+            T* const* data;
+            size_t lo, hi, less, not_greater;
+        };
+        std::vector<run> runs;
+        if (!loose.empty())
+            runs.push_back({loose.data(), 0, loose.size(), 0, 0});
+        for (list_Node* p : whole) {
+            const std::vector<T*>& s = sorted_block(p);
+            runs.push_back({s.data(), 0, s.size(), 0, 0});
+        }
+        struct median {
+            T* val;
+            size_t weight;
+        };
+        std::vector<median> medians;
+        while (true) {
+            medians.clear();
+            size_t total = 0;
+            for (const run& rn : runs) {
+                if (rn.lo == rn.hi)
+                    continue;
+                medians.push_back(
+                    {rn.data[rn.lo + (rn.hi - rn.lo) / 2], rn.hi - rn.lo});
+                total += rn.hi - rn.lo;
+            }
+            std::sort(medians.begin(), medians.end(),
+                      [](const median& a, const median& b) {
+                          return value_less(a.val, b.val);
+                      });
+            T* pivot = medians.back().val;
+            size_t acc = 0;
+            for (const median& m : medians) {
+                acc += m.weight;
+                if (2 * acc >= total) {
+                    pivot = m.val;
+                    break;
+                }
+            }
+            size_t less = 0, not_greater = 0;
+            for (run& rn : runs) {
+                T* const* lo = rn.data + rn.lo;
+                T* const* hi = rn.data + rn.hi;
+                rn.less = std::lower_bound(lo, hi, pivot, value_less) - lo;
+                rn.not_greater =
+                    std::upper_bound(lo, hi, pivot, value_less) - lo;
+                less += rn.less;
+                not_greater += rn.not_greater;
+            }
+            if (k < less) {
+                for (run& rn : runs)
+                    rn.hi = rn.lo + rn.less;
+            } else if (k < not_greater) {
+                return *pivot;
+            } else {
+                k -= not_greater;
+                for (run& rn : runs)
+                    rn.lo += rn.not_greater;
+            }
+        }
     }
 };
-template <class T>
-size_t deque<T>::last_modified_Size = DEFAULT_CAPACITY;
+
+/**
+ * deque<bool> packs its flags 64 to a word, see bit_deque, instead of a
+ * node and a heap bool each. like std::vector<bool>, its elements are
+ * reached through a proxy reference. InlineN and the policies have no
+ * meaning for it, and it has no flat ring, snapshots or rank queries.
+ */
+template <size_t InlineN, class BlockPolicy, class CheckPolicy>
+class deque<bool, InlineN, BlockPolicy, CheckPolicy> : public bit_deque<1> {
+   public:
+    using bit_deque<1>::bit_deque;
+};
+
+template <class T, size_t InlineN, class BlockPolicy, class CheckPolicy>
+void swap(deque<T, InlineN, BlockPolicy, CheckPolicy>& lhs,
+          deque<T, InlineN, BlockPolicy, CheckPolicy>& rhs) {
+    lhs.swap(rhs);
+}
 }  // namespace sjtu
 
 #endif
@@ -0,0 +1,328 @@
+#ifndef SJTU_DURABLE_DEQUE_HPP
+#define SJTU_DURABLE_DEQUE_HPP
+#include "deque.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+namespace sjtu {
+/**
+ * a queue that survives a crash of the process.
+ * push_back appends a record to the newest segment file of a log
+ * directory, and pop_front advances a head sequence number kept in a
+ * small head file. the values themselves are also kept in memory, in a
+ * sjtu::deque, so front() and at() never touch the disk.
+ *
+ * changes are made durable in groups: every sync_every pushes and pops,
+ * or on commit(), the pending records are written and the segment is
+ * fdatasync'ed, then the head. a crash loses the changes after the last
+ * commit and nothing before it. a crash between the two syncs can
+ * replay pops, never lose pushes, so consumers must tolerate seeing an
+ * element twice.
+ *
+ * a segment is closed once it grows past segment_bytes and deleted once
+ * every record in it has been popped and the head committed.
+ * on opening, the segments are replayed; a torn or corrupt record and
+ * everything after it is cut off.
+ * elements are stored through serializer<T>.
+ * only push_back and pop_front change the queue.
+ */
+template <class T>
+class durable_deque {
+   public:
+    class segment {
+       public:
+        uint64_t first;  // sequence number of the first record
+        size_t count;    // records in the segment
+    };
+
+    std::string dir;
+    deque<T> values;
+    deque<segment> segments;
+    // sequence numbers: head is the front, synced_head is on disk
+    uint64_t head = 0;
+    uint64_t synced_head = 0;
+    size_t sync_every;
+    size_t segment_bytes;
+    // records of the unsynced pushes, in file format
+    std::string pending;
+    size_t unsynced = 0;
+    int active_fd = -1;
+    size_t active_bytes = 0;
+    int head_fd = -1;
+    // fdatasync calls, for the benchmark
+    size_t syncs = 0;
+
+    // a record is its payload length, a checksum and the payload
+    static constexpr size_t record_header = 2 * sizeof(uint32_t);
+
+   public:
+    /**
+     * open the queue in directory path, creating it if needed, and
+     * replay what is there.
+     * throw runtime_error if the directory or its files cannot be used.
+     */
+    explicit durable_deque(const char* path, size_t sync_every = 64,
+                           size_t segment_bytes = 64 * 1024 * 1024)
+        : dir(path), sync_every(std::max(sync_every, (size_t)1)),
+          segment_bytes(segment_bytes) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        head_fd = ::open(file_name("head").c_str(), O_RDWR | O_CREAT, 0644);
+        if (head_fd < 0)
+            throw runtime_error("durable_deque: cannot open head file");
+        uint64_t saved[2];
+        if (::pread(head_fd, saved, sizeof(saved), 0) == sizeof(saved) &&
+            saved[1] == ~saved[0])
+            head = synced_head = saved[0];
+        recover();
+    }
+    durable_deque(const durable_deque& other) = delete;
+    durable_deque& operator=(const durable_deque& other) = delete;
+
+    /**
+     * deconstructor, commits what is pending.
+     */
+    ~durable_deque() {
+        try {
+            commit();
+        } catch (...) {
+        }
+        ::close(active_fd);
+        ::close(head_fd);
+    }
+
+    /**
+     * access, all from memory.
+     */
+    const T& at(const size_t& pos) const { return values.at(pos); }
+    const T& operator[](const size_t& pos) const { return values.at(pos); }
+    const T& front() const { return values.front(); }
+    const T& back() const { return values.back(); }
+    typename deque<T>::const_iterator cbegin() const {
+        return values.cbegin();
+    }
+    typename deque<T>::const_iterator cend() const { return values.cend(); }
+    bool empty() const { return values.empty(); }
+    size_t size() const { return values.size(); }
+
+    /**
+     * append value, durable after the next commit.
+     */
+    void push_back(const T& value) {
+        size_t start = pending.size();
+        pending.resize(start + record_header);
+        if constexpr (serializer<T>::raw) {
+            pending.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        } else {
+            std::ostringstream os;
+            serializer<T>::write(os, value);
+            pending += os.str();
+        }
+        size_t length = pending.size() - start - record_header;
+        uint32_t header[2] = {
+            (uint32_t)length,
+            checksum(pending.data() + start + record_header, length)};
+        std::memcpy(&pending[start], header, record_header);
+        values.push_back(value);
+        segments[segments.size() - 1].count++;
+        changed();
+    }
+    /**
+     * remove the front, durable after the next commit.
+     * throw container_is_empty when the container is empty.
+     */
+    void pop_front() {
+        if (values.empty())
+            throw container_is_empty("pop_front function: container is empty");
+        values.pop_front();
+        ++head;
+        changed();
+    }
+
+    /**
+     * make every push and pop so far durable: write the pending records,
+     * fdatasync the segment, then write and fdatasync the head.
+     * then delete the segments that have been popped entirely, and start
+     * a new segment if the current one is full.
+     * throw runtime_error if a write or a sync fails.
+     */
+    void commit() {
+        if (!pending.empty()) {
+            write_all(active_fd, pending.data(), pending.size());
+            sync(active_fd);
+            active_bytes += pending.size();
+            pending.clear();
+        }
+        if (synced_head != head) {
+            uint64_t saved[2] = {head, ~head};
+            if (::pwrite(head_fd, saved, sizeof(saved), 0) != sizeof(saved))
+                throw runtime_error("durable_deque: cannot write head file");
+            sync(head_fd);
+            synced_head = head;
+        }
+        unsynced = 0;
+        while (segments.size() > 1 &&
+               segments.front().first + segments.front().count <=
+                   synced_head) {
+            std::remove(segment_name(segments.front().first).c_str());
+            segments.pop_front();
+        }
+        if (active_bytes >= segment_bytes)
+            open_segment(head + values.size());
+    }
+
+    //------------------------------
+    // files
+    //------------------------------
+    std::string file_name(const char* name) const { return dir + "/" + name; }
+    std::string segment_name(uint64_t first) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%020llu.log",
+                      (unsigned long long)first);
+        return file_name(name);
+    }
+    // FNV-1a, to catch torn and corrupt records
+    static uint32_t checksum(const char* data, size_t bytes) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < bytes; i++)
+            hash = (hash ^ (unsigned char)data[i]) * 16777619u;
+        return hash;
+    }
+    void changed() {
+        if (++unsynced >= sync_every)
+            commit();
+    }
+    void sync(int fd) {
+        ++syncs;
+        if (::fdatasync(fd) != 0)
+            throw runtime_error("durable_deque: fdatasync failed");
+    }
+    static void write_all(int fd, const char* data, size_t bytes) {
+        while (bytes) {
+            ssize_t ret = ::write(fd, data, bytes);
+            if (ret <= 0)
+                throw runtime_error("durable_deque: cannot write segment");
+            data += ret;
+            bytes -= ret;
+        }
+    }
+    // close the active segment and start a new one at sequence first;
+    // the directory is synced so that the new file survives a crash
+    void open_segment(uint64_t first) {
+        if (active_fd >= 0)
+            ::close(active_fd);
+        active_fd = ::open(segment_name(first).c_str(),
+                           O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (active_fd < 0)
+            throw runtime_error("durable_deque: cannot open segment");
+        active_bytes = 0;
+        segments.push_back(segment{first, 0});
+        int dir_fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dir_fd >= 0) {
+            ::fsync(dir_fd);
+            ::close(dir_fd);
+        }
+    }
+    /**
+     * replay the segments in order, from the head on.
+     * a segment is cut at its first bad record, and the segments after
+     * it are deleted, since their records no longer follow on.
+     */
+    void recover() {
+        std::vector<uint64_t> found;
+        for (auto& entry : std::filesystem::directory_iterator(dir)) {
+            std::string name = entry.path().filename().string();
+            if (name.size() == 24 && name.compare(20, 4, ".log") == 0)
+                found.push_back(std::stoull(name.substr(0, 20)));
+        }
+        std::sort(found.begin(), found.end());
+        bool broken = false;
+        uint64_t next = head;
+        for (uint64_t first : found) {
+            std::string path = segment_name(first);
+            if (broken || first > next) {
+                // after a cut, or a gap: nothing here follows on
+                broken = true;
+                std::remove(path.c_str());
+                continue;
+            }
+            std::ifstream is(path, std::ios::binary);
+            std::string data((std::istreambuf_iterator<char>(is)),
+                             std::istreambuf_iterator<char>());
+            size_t pos = 0, count = 0;
+            while (true) {
+                size_t length = read_record(data, pos, first + count);
+                if (length == (size_t)-1)
+                    break;
+                pos += record_header + length;
+                ++count;
+            }
+            if (pos < data.size()) {
+                broken = true;
+                std::filesystem::resize_file(path, pos);
+            }
+            if (first + count <= head && !broken) {
+                std::remove(path.c_str());  // popped before the crash
+                continue;
+            }
+            segments.push_back(segment{first, count});
+            next = first + count;
+            active_bytes = pos;
+        }
+        if (head > next) {
+            // the head was synced past records that never were
+            head = synced_head = next;
+        }
+        if (segments.empty()) {
+            open_segment(head);
+            return;
+        }
+        active_fd = ::open(segment_name(segments.back().first).c_str(),
+                           O_WRONLY | O_APPEND);
+        if (active_fd < 0)
+            throw runtime_error("durable_deque: cannot open segment");
+    }
+    // check the record at pos and keep its value if it is at or past
+    // the head; return its length, or -1 if it is torn or corrupt
+    size_t read_record(const std::string& data, size_t pos, uint64_t seq) {
+        if (data.size() - pos < record_header)
+            return -1;
+        uint32_t header[2];
+        std::memcpy(header, data.data() + pos, record_header);
+        const char* payload = data.data() + pos + record_header;
+        if (data.size() - pos - record_header < header[0] ||
+            checksum(payload, header[0]) != header[1])
+            return -1;
+        if (seq < head)
+            return header[0];
+        if constexpr (serializer<T>::raw) {
+            if (header[0] != sizeof(T))
+                return -1;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type buf;
+            std::memcpy(&buf, payload, sizeof(T));
+            values.push_back(*reinterpret_cast<T*>(&buf));
+        } else {
+            std::istringstream is(std::string(payload, header[0]));
+            try {
+                values.push_back(serializer<T>::read(is));
+            } catch (std::exception&) {
+                return -1;
+            }
+        }
+        return header[0];
+    }
+};
+}  // namespace sjtu
+
+#endif
@@ -3,41 +3,81 @@
 
 #include <cstddef>
 #include <cstring>
-#include <string>
+#include <exception>
 
-/*
- * You don't have to implement exceptions.hpp.
- * Just remember to throw exception when needed.
- */
 namespace sjtu {
 
-class exception {
-protected:
-    const std::string variant = "";
-    std::string detail = "";
-public:
-    exception() {}
-    exception(const exception &ec) : variant(ec.variant), detail(ec.detail) {}
-    virtual std::string what() {
-        return variant + " " + detail;
-    }
+/**
+ * what went wrong, one code per exception class below.
+ */
+enum class error_code {
+    unknown,
+    index_out_of_bound,
+    runtime_error,
+    invalid_iterator,
+    container_is_empty,
+    container_is_full
+};
+
+/**
+ * base of the exceptions thrown by the containers.
+ * both messages are string literals, so constructing, copying and
+ * throwing an exception never allocates.
+ * variant names the class, detail says which function threw and why.
+ */
+class exception : public std::exception {
+   protected:
+    const char* variant = "exception";
+    const char* detail = "";
+    error_code ec = error_code::unknown;
+
+   public:
+    exception() noexcept {}
+    exception(const char* variant, const char* detail, error_code ec) noexcept
+        : variant(variant), detail(detail), ec(ec) {}
+    exception(const exception& other) noexcept = default;
+    exception& operator=(const exception& other) noexcept = default;
+
+    const char* what() const noexcept override { return detail; }
+    const char* kind() const noexcept { return variant; }
+    error_code code() const noexcept { return ec; }
 };
 
 class index_out_of_bound : public exception {
-    /* __________________________ */
+   public:
+    explicit index_out_of_bound(
+        const char* detail = "index out of bound") noexcept
+        : exception("index_out_of_bound", detail,
+                    error_code::index_out_of_bound) {}
 };
 
 class runtime_error : public exception {
-    /* __________________________ */
+   public:
+    explicit runtime_error(const char* detail = "runtime error") noexcept
+        : exception("runtime_error", detail, error_code::runtime_error) {}
 };
 
 class invalid_iterator : public exception {
-    /* __________________________ */
+   public:
+    explicit invalid_iterator(const char* detail = "invalid iterator") noexcept
+        : exception("invalid_iterator", detail, error_code::invalid_iterator) {}
 };
 
 class container_is_empty : public exception {
-    /* __________________________ */
+   public:
+    explicit container_is_empty(
+        const char* detail = "container is empty") noexcept
+        : exception("container_is_empty", detail,
+                    error_code::container_is_empty) {}
+};
+
+class container_is_full : public exception {
+   public:
+    explicit container_is_full(
+        const char* detail = "container is full") noexcept
+        : exception("container_is_full", detail,
+                    error_code::container_is_full) {}
 };
-}
+}  // namespace sjtu
 
 #endif
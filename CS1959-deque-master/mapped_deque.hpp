@@ -0,0 +1,234 @@
+#ifndef SJTU_MAPPED_DEQUE_HPP
+#define SJTU_MAPPED_DEQUE_HPP
+#include "deque.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+namespace sjtu {
+/**
+ * a read-only view of a deque snapshot file, see deque::save.
+ * the file is mapped into memory and the elements are read in place:
+ * opening costs one mmap whatever the size, and pages are only read
+ * from disk when an element on them is first touched.
+ * the block payloads of a snapshot follow each other without gaps,
+ * so element i sits at a fixed offset and at() is O(1). the payload
+ * starts at a multiple of alignof(T), so it can be read in place.
+ * only for raw element types, written byte for byte.
+ * the view must not outlive changes to the file.
+ */
+template <class T>
+class mapped_deque {
+    static_assert(serializer<T>::raw,
+                  "mapped_deque: T must be trivially copyable");
+
+   public:
+    const T* data = nullptr;
+    size_t total_size = 0;
+    void* map_base = MAP_FAILED;
+    size_t map_bytes = 0;
+
+    // header words, element count and block count, see deque::save
+    static constexpr size_t header_bytes = deque<T>::snapshot_header;
+
+   public:
+    class const_iterator {
+       public:
+        const mapped_deque* check_ptr;
+        size_t pos;
+
+       public:
+        const_iterator(const mapped_deque* ptr1 = nullptr, size_t ptr2 = 0)
+            : check_ptr(ptr1), pos(ptr2) {}
+        const_iterator operator+(const std::ptrdiff_t& n) const {
+            return const_iterator(check_ptr, pos + n);
+        }
+        const_iterator operator-(const std::ptrdiff_t& n) const {
+            return const_iterator(check_ptr, pos - n);
+        }
+        std::ptrdiff_t operator-(const const_iterator& rhs) const {
+            if (check_ptr != rhs.check_ptr)
+                throw invalid_iterator(
+                    "distance function: not the same list");
+            return (std::ptrdiff_t)pos - (std::ptrdiff_t)rhs.pos;
+        }
+        const_iterator& operator+=(const std::ptrdiff_t& n) {
+            pos += n;
+            return *this;
+        }
+        const_iterator& operator-=(const std::ptrdiff_t& n) {
+            pos -= n;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator iter = *this;
+            ++*this;
+            return iter;
+        }
+        const_iterator& operator++() {
+            if (!check_ptr || pos >= check_ptr->total_size)
+                throw index_out_of_bound(
+                    "iterator funtion: index out of bound");
+            ++pos;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator iter = *this;
+            --*this;
+            return iter;
+        }
+        const_iterator& operator--() {
+            if (!check_ptr || pos == 0)
+                throw index_out_of_bound(
+                    "iterator funtion: index out of bound");
+            --pos;
+            return *this;
+        }
+        const T& operator*() const {
+            if (check_ptr && pos < check_ptr->total_size)
+                return check_ptr->data[pos];
+            throw invalid_iterator("operator* function: invalid iterator");
+        }
+        const T* operator->() const { return &**this; }
+        bool operator==(const const_iterator& rhs) const {
+            return check_ptr == rhs.check_ptr && pos == rhs.pos;
+        }
+        bool operator!=(const const_iterator& rhs) const {
+            return !(*this == rhs);
+        }
+    };
+    using iterator = const_iterator;
+
+   public:
+    /**
+     * map the snapshot at path.
+     * throw runtime_error if the file cannot be mapped, is not a snapshot
+     * of raw T, or is shorter than its header says.
+     */
+    explicit mapped_deque(const char* path) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            throw runtime_error("mapped_deque: cannot open file");
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && (size_t)st.st_size >= header_bytes) {
+            map_bytes = st.st_size;
+            map_base = ::mmap(nullptr, map_bytes, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (map_base == MAP_FAILED)
+            throw runtime_error("mapped_deque: cannot map file");
+        try {
+            check_header();
+        } catch (...) {
+            ::munmap(map_base, map_bytes);
+            throw;
+        }
+    }
+    mapped_deque(const mapped_deque& other) = delete;
+    mapped_deque& operator=(const mapped_deque& other) = delete;
+    mapped_deque(mapped_deque&& other) noexcept { *this = std::move(other); }
+    mapped_deque& operator=(mapped_deque&& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(total_size, other.total_size);
+        std::swap(map_base, other.map_base);
+        std::swap(map_bytes, other.map_bytes);
+        return *this;
+    }
+
+    /**
+     * deconstructor.
+     */
+    ~mapped_deque() {
+        if (map_base != MAP_FAILED)
+            ::munmap(map_base, map_bytes);
+    }
+
+    /**
+     * access a specified element with bound checking.
+     * throw index_out_of_bound if out of bound.
+     */
+    const T& at(const size_t& pos) const {
+        if (pos >= total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        return data[pos];
+    }
+    const T& operator[](const size_t& pos) const { return at(pos); }
+
+    /**
+     * access the first element.
+     * throw container_is_empty when the container is empty.
+     */
+    const T& front() const {
+        if (!total_size)
+            throw container_is_empty("front function: container is empty");
+        return data[0];
+    }
+    /**
+     * access the last element.
+     * throw container_is_empty when the container is empty.
+     */
+    const T& back() const {
+        if (!total_size)
+            throw container_is_empty("back function: container is empty");
+        return data[total_size - 1];
+    }
+
+    /**
+     * iterators.
+     */
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator cbegin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, total_size); }
+    const_iterator cend() const { return const_iterator(this, total_size); }
+
+    /**
+     * size.
+     */
+    bool empty() const { return !total_size; }
+    size_t size() const { return total_size; }
+
+    /**
+     * copy the elements into a heap-backed sjtu::deque, to modify them.
+     */
+    deque<T> to_deque() const {
+        deque<T> ret;
+        ret.reserve(total_size);
+        for (size_t i = 0; i < total_size; i++)
+            ret.push_back(data[i]);
+        return ret;
+    }
+
+    // validate the header and point data at the payload
+    void check_header() {
+        const unsigned char* base = static_cast<const unsigned char*>(map_base);
+        uint32_t header[4];
+        uint64_t counts[2];
+        std::memcpy(header, base, sizeof(header));
+        std::memcpy(counts, base + sizeof(header), sizeof(counts));
+        if (header[0] != deque<T>::snapshot_magic || header[1] == 0 ||
+            header[1] > deque<T>::snapshot_version)
+            throw runtime_error("mapped_deque: not a deque snapshot");
+        if (header[2] != sizeof(T))
+            throw runtime_error("mapped_deque: element type mismatch");
+        size_t n = counts[0], blocks = counts[1];
+        // the table alone may not fit, so check it before the payload
+        if (blocks > (map_bytes - header_bytes) / sizeof(uint64_t))
+            throw runtime_error("mapped_deque: truncated snapshot");
+        size_t offset = deque<T>::snapshot_offset(blocks, header[3]);
+        if (offset > map_bytes || n > (map_bytes - offset) / sizeof(T))
+            throw runtime_error("mapped_deque: truncated snapshot");
+        if (offset % alignof(T))
+            throw runtime_error("mapped_deque: misaligned payload");
+        data = reinterpret_cast<const T*>(base + offset);
+        total_size = n;
+    }
+};
+}  // namespace sjtu
+
+#endif
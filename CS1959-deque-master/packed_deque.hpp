@@ -0,0 +1,272 @@
+#ifndef SJTU_PACKED_DEQUE_HPP
+#define SJTU_PACKED_DEQUE_HPP
+#include "block_map.hpp"
+#include "deque.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+namespace sjtu {
+/**
+ * a deque of integers that keeps its cold blocks compressed.
+ * the elements sit in fixed blocks of BlockElements. the two end blocks
+ * are always plain arrays; the interior blocks stay plain up to
+ * max_thawed of them, past that the least recently used one is frozen:
+ * its first value and the smallest difference between neighbours are
+ * kept, and each difference is bit-packed as its excess over the
+ * smallest, at the width of the largest excess.
+ * reading a frozen block thaws it back, freezing another.
+ * timestamps, sequence numbers and other slowly changing sequences pack
+ * to a few bits an element; random values do not compress and cost the
+ * same as plain.
+ * a thawed block keeps its packed copy until it is written, so freezing
+ * it again after reads is free.
+ * pushes and pops at either end never decode anything, except that
+ * popping into a frozen block thaws it.
+ * the blocks are full except the two ends, so at(i) finds its block in O(1).
+ * there is no insert or erase in the middle.
+ * a reference returned by at() is invalidated by any later access that
+ * freezes its block.
+ */
+template <class T, size_t BlockElements = 4096>
+class packed_deque {
+    static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                  "packed_deque: T must be an integer type");
+    static_assert(BlockElements > 1, "packed_deque: blocks too small");
+
+   public:
+    using value_type = T;
+    using U = typename std::make_unsigned<T>::type;
+    using S = typename std::make_signed<T>::type;
+    static constexpr size_t block_elements = BlockElements;
+    static constexpr size_t block_bytes = BlockElements * sizeof(T);
+    static constexpr unsigned bits = 8 * sizeof(T);
+
+    class block {
+       public:
+        T* data = nullptr;  // nullptr while frozen
+        // the packed copy, kept while it matches data
+        bool packed = false;
+        uint64_t* words = nullptr;  // nullptr if every difference is 0
+        T base;                     // the first element
+        S step;                     // the smallest difference
+        unsigned char width;        // bits a difference
+        // the lru list of thawed interior blocks, most recent first
+        block* lru_prev = nullptr;
+        block* lru_next = nullptr;
+        bool in_lru = false;
+    };
+
+    fixed_block_map<packed_deque, block, block_elements> map{this};
+
+    size_t max_thawed;
+    mutable size_t thawed = 0;  // plain blocks, the two ends included
+    mutable size_t packed_words = 0;
+    // counters, for tuning max_thawed
+    mutable size_t freezes = 0;
+    mutable size_t thaws = 0;
+
+   public:
+    using const_iterator = position_iterator<packed_deque>;
+    using iterator = const_iterator;
+
+   public:
+    /**
+     * keep at most max_thawed interior blocks plain.
+     */
+    explicit packed_deque(size_t max_thawed = 8) : max_thawed(max_thawed) {}
+    packed_deque(const packed_deque& other) = delete;
+    packed_deque& operator=(const packed_deque& other) = delete;
+
+    /**
+     * deconstructor.
+     */
+    ~packed_deque() { map.free_blocks(); }
+
+    /**
+     * access a specified element with bound checking, thawing its block
+     * if it was frozen. writing through the reference drops the packed
+     * copy of the block.
+     * throw index_out_of_bound if out of bound.
+     */
+    const T& at(const size_t& pos) const {
+        if (pos >= map.total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        return map.touch(map.block_of(pos))->data[map.slot_of(pos)];
+    }
+    T& at(const size_t& pos) {
+        if (pos >= map.total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        block* blk = map.touch(map.block_of(pos));
+        written(blk);
+        return blk->data[map.slot_of(pos)];
+    }
+    const T& operator[](const size_t& pos) const { return at(pos); }
+    T& operator[](const size_t& pos) { return at(pos); }
+
+    /**
+     * access the first and the last element, both always plain.
+     * throw container_is_empty when the container is empty.
+     */
+    const T& front() const {
+        if (!map.total_size)
+            throw container_is_empty("front function: container is empty");
+        return map.front()->data[map.head];
+    }
+    const T& back() const {
+        if (!map.total_size)
+            throw container_is_empty("back function: container is empty");
+        return map.back()->data[map.slot_of(map.total_size - 1)];
+    }
+
+    /**
+     * iterators.
+     */
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator cbegin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+    const_iterator cend() const { return const_iterator(this, size()); }
+
+    /**
+     * size.
+     */
+    bool empty() const { return !map.total_size; }
+    size_t size() const { return map.total_size; }
+    size_t frozen_blocks() const { return map.blocks - thawed; }
+    /**
+     * bytes held for the elements: the plain blocks, the packed words
+     * and the block records.
+     */
+    size_t memory_bytes() const {
+        return thawed * block_bytes + packed_words * sizeof(uint64_t) +
+               map.blocks * sizeof(block) + map.memory_bytes();
+    }
+
+    /**
+     * clear all contents.
+     */
+    void clear() { map.free_blocks(); }
+
+    /**
+     * push and pop at both ends.
+     * a push may freeze the block next to the end it opens a block at;
+     * a pop that empties an end block thaws its neighbour.
+     */
+    void push_back(const T& value) {
+        size_t slot;
+        map.open_back(slot)->data[slot] = value;
+    }
+    void push_front(const T& value) {
+        size_t slot;
+        map.open_front(slot)->data[slot] = value;
+    }
+    void pop_back() {
+        if (!map.total_size)
+            throw container_is_empty("pop_back function: container is empty");
+        map.close_back();
+    }
+    void pop_front() {
+        if (!map.total_size)
+            throw container_is_empty("pop_front function: container is empty");
+        map.close_front();
+    }
+
+    //------------------------------
+    // blocks and packing, the steps fixed_block_map calls
+    //------------------------------
+    block* new_block() {
+        block* blk = new block;
+        blk->data = new T[block_elements];
+        ++thawed;
+        return blk;
+    }
+    void free_block(block* blk) {
+        if (blk->data) {
+            delete[] blk->data;
+            --thawed;
+        }
+        written(blk);
+        delete blk;
+    }
+    // the packed copy no longer matches
+    void written(block* blk) const {
+        if (blk->packed) {
+            delete[] blk->words;
+            blk->words = nullptr;
+            blk->packed = false;
+            packed_words -= words_for(blk->width);
+        }
+    }
+    bool over_cap() const { return thawed > max_thawed + 2; }
+
+    static size_t words_for(unsigned width) {
+        return ((block_elements - 1) * width + 63) / 64;
+    }
+    // the difference of two neighbours, wrapping around
+    static S delta(T prev, T value) { return (S)(U)((U)value - (U)prev); }
+    // freeze: pack the block unless its packed copy still matches,
+    // and free the plain array
+    void evict(block* blk) const {
+        if (!blk->packed) {
+            const T* data = blk->data;
+            S low = delta(data[0], data[1]), high = low;
+            for (size_t i = 2; i < block_elements; i++) {
+                S d = delta(data[i - 1], data[i]);
+                low = d < low ? d : low;
+                high = d > high ? d : high;
+            }
+            uint64_t range = (U)((U)high - (U)low);
+            unsigned width = 0;
+            while (width < 64 && range >> width)
+                ++width;
+            size_t n = words_for(width);
+            uint64_t* words = n ? new uint64_t[n]() : nullptr;
+            for (size_t i = 1, bit = 0; width && i < block_elements;
+                 i++, bit += width) {
+                uint64_t z = (U)((U)delta(data[i - 1], data[i]) - (U)low);
+                size_t w = bit / 64, off = bit % 64;
+                words[w] |= z << off;
+                if (off + width > 64)
+                    words[w + 1] |= z >> (64 - off);
+            }
+            blk->packed = true;
+            blk->words = words;
+            blk->base = data[0];
+            blk->step = low;
+            blk->width = width;
+            packed_words += n;
+        }
+        delete[] blk->data;
+        blk->data = nullptr;
+        --thawed;
+        ++freezes;
+    }
+    // thaw: decode the packed copy, which is kept
+    void restore(block* blk) const {
+        if (blk->data)
+            return;
+        ++thaws;
+        T* data = new T[block_elements];
+        unsigned width = blk->width;
+        const uint64_t* words = blk->words;
+        uint64_t mask = width == 64 ? ~(uint64_t)0 : ((uint64_t)1 << width) - 1;
+        U step = blk->step;
+        data[0] = blk->base;
+        for (size_t i = 1, bit = 0; i < block_elements; i++, bit += width) {
+            uint64_t z = 0;
+            if (width) {
+                size_t w = bit / 64, off = bit % 64;
+                z = words[w] >> off;
+                if (off + width > 64)
+                    z |= words[w + 1] << (64 - off);
+                z &= mask;
+            }
+            data[i] = (T)(U)((U)data[i - 1] + (U)step + (U)z);
+        }
+        blk->data = data;
+        ++thawed;
+    }
+};
+}  // namespace sjtu
+
+#endif
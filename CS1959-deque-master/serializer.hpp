@@ -0,0 +1,122 @@
+#ifndef SJTU_SERIALIZER_HPP
+#define SJTU_SERIALIZER_HPP
+
+#include "exceptions.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace Util {
+class Bint;
+}
+namespace Diamond {
+template <typename _Td>
+class Matrix;
+}
+
+namespace sjtu {
+/**
+ * unformatted reads and writes for the snapshot format.
+ * a short read or a failed write throws runtime_error.
+ */
+inline void write_raw(std::ostream& os, const void* src, size_t bytes) {
+    if (bytes && !os.write(static_cast<const char*>(src), bytes))
+        throw runtime_error("snapshot: write failed");
+}
+inline void read_raw(std::istream& is, void* dst, size_t bytes) {
+    if (bytes && !is.read(static_cast<char*>(dst), bytes))
+        throw runtime_error("snapshot: truncated input");
+}
+inline void write_u64(std::ostream& os, uint64_t value) {
+    write_raw(os, &value, sizeof(value));
+}
+inline uint64_t read_u64(std::istream& is) {
+    uint64_t value;
+    read_raw(is, &value, sizeof(value));
+    return value;
+}
+
+/**
+ * how a deque snapshot stores one T.
+ * raw types are copied byte for byte, a whole block at a time.
+ * any other type needs a specialization with
+ *     static void write(std::ostream& os, const T& value);
+ *     static T read(std::istream& is);
+ * which may throw on bad input.
+ */
+template <class T, class Enable = void>
+class serializer {
+   public:
+    static constexpr bool raw = false;
+};
+template <class T>
+class serializer<T, std::enable_if_t<std::is_trivially_copyable<T>::value>> {
+   public:
+    static constexpr bool raw = true;
+    static void write(std::ostream& os, const T& value) {
+        write_raw(os, &value, sizeof(T));
+    }
+    static T read(std::istream& is) {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type buf;
+        read_raw(is, &buf, sizeof(T));
+        return *reinterpret_cast<T*>(&buf);
+    }
+};
+
+/**
+ * a Bint is stored as its decimal digits with a length in front.
+ * the members are templates so that Bint only has to be complete
+ * where a snapshot of it is taken.
+ */
+template <>
+class serializer<Util::Bint> {
+   public:
+    static constexpr bool raw = false;
+    template <class B>
+    static void write(std::ostream& os, const B& value) {
+        std::ostringstream text;
+        text << value;
+        std::string digits = text.str();
+        write_u64(os, digits.size());
+        write_raw(os, digits.data(), digits.size());
+    }
+    template <class B = Util::Bint>
+    static B read(std::istream& is) {
+        std::string digits(read_u64(is), '\0');
+        read_raw(is, &digits[0], digits.size());
+        return digits.empty() ? B() : B(digits);
+    }
+};
+
+/**
+ * a Matrix is stored as its row and column counts, then the entries
+ * row by row, each through the serializer of the entry type.
+ */
+template <typename _Td>
+class serializer<Diamond::Matrix<_Td>> {
+   public:
+    static constexpr bool raw = false;
+    static void write(std::ostream& os, const Diamond::Matrix<_Td>& value) {
+        write_u64(os, value.RowSize());
+        write_u64(os, value.ColSize());
+        for (size_t i = 0; i < value.RowSize(); i++)
+            for (size_t j = 0; j < value.ColSize(); j++)
+                serializer<_Td>::write(os, value[i][j]);
+    }
+    static Diamond::Matrix<_Td> read(std::istream& is) {
+        size_t rows = read_u64(is), cols = read_u64(is);
+        Diamond::Matrix<_Td> value(rows, cols);
+        for (size_t i = 0; i < rows; i++)
+            for (size_t j = 0; j < cols; j++)
+                value[i][j] = serializer<_Td>::read(is);
+        return value;
+    }
+};
+}  // namespace sjtu
+
+#endif
@@ -0,0 +1,446 @@
+#ifndef SJTU_SHM_DEQUE_HPP
+#define SJTU_SHM_DEQUE_HPP
+#include "deque.hpp"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+namespace sjtu {
+/**
+ * a deque in a POSIX shared memory object, for producers and consumers
+ * in different processes on one host.
+ * the header, the blocks and the links all live in the shared object;
+ * blocks are linked by their offset from the start of the object, since
+ * each process maps it at its own address. a process-shared robust mutex
+ * guards every operation, and two condition variables let wait_push_*
+ * and wait_pop_* sleep until there is room or an element. if a process
+ * dies holding the mutex, it may have left the links and counts half
+ * updated: the next process to lock it marks the deque poisoned, and
+ * from then on every operation throws runtime_error until reset()
+ * empties it.
+ * the capacity is fixed when the object is created; the blocks are
+ * carved out of it then and recycled through a free list.
+ * only for raw element types, which are copied byte for byte.
+ */
+template <class T, size_t BlockBytes = 4096>
+class shm_deque {
+    static_assert(serializer<T>::raw,
+                  "shm_deque: T must be trivially copyable");
+
+   public:
+    // a block is its links followed by its elements
+    class block {
+       public:
+        uint64_t prev;
+        uint64_t next;
+    };
+    static constexpr size_t data_align =
+        alignof(T) > alignof(block) ? alignof(T) : alignof(block);
+    static constexpr size_t data_offset =
+        (sizeof(block) + alignof(T) - 1) / alignof(T) * alignof(T);
+    static constexpr size_t block_elements =
+        BlockBytes > data_offset + sizeof(T)
+            ? (BlockBytes - data_offset) / sizeof(T)
+            : 1;
+    static constexpr size_t block_stride =
+        (data_offset + block_elements * sizeof(T) + data_align - 1) /
+        data_align * data_align;
+    static constexpr uint32_t shm_magic = 0x4d485344;  // "DSHM"
+
+    class header {
+       public:
+        std::atomic<uint32_t> ready;  // shm_magic once initialized
+        uint32_t element_bytes;
+        uint64_t block_elements;
+        uint64_t bytes;  // size of the whole object
+        uint64_t capacity;
+        pthread_mutex_t mutex;
+        pthread_cond_t not_empty;
+        pthread_cond_t not_full;
+        // offsets of the end blocks and the free list, 0 for none
+        uint64_t head_block;
+        uint64_t tail_block;
+        uint64_t free_block;
+        // the elements are [head_pos, tail_pos) of the blocks in between
+        uint64_t head_pos;
+        uint64_t tail_pos;
+        uint64_t total_size;
+        uint32_t poisoned;  // a process died holding the mutex
+    };
+    static constexpr size_t blocks_offset =
+        (sizeof(header) + data_align - 1) / data_align * data_align;
+
+    // room for a T, which need not be default constructible
+    class slot {
+       public:
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type buf;
+        T* get() { return reinterpret_cast<T*>(&buf); }
+    };
+
+    unsigned char* base = nullptr;
+    size_t map_bytes = 0;
+    header* hdr = nullptr;
+
+    // holds the mutex of the object. a dead owner poisons the deque,
+    // which is then refused until reset()
+    class guard {
+       public:
+        header* hdr;
+        explicit guard(header* hdr, bool repair = false) : hdr(hdr) {
+            int ret = pthread_mutex_lock(&hdr->mutex);
+            if (ret != 0 && ret != EOWNERDEAD)
+                throw runtime_error("shm_deque: cannot lock shared memory");
+            if (!check(ret) && !repair) {
+                pthread_mutex_unlock(&hdr->mutex);
+                throw runtime_error("shm_deque: poisoned by a dead process");
+            }
+        }
+        ~guard() { pthread_mutex_unlock(&hdr->mutex); }
+        void wait(pthread_cond_t* cond) {
+            if (!check(pthread_cond_wait(cond, &hdr->mutex)))
+                throw runtime_error("shm_deque: poisoned by a dead process");
+        }
+        // false if the deque is poisoned, poisoning it on EOWNERDEAD and
+        // waking the sleepers so they see it
+        bool check(int ret) {
+            if (ret == EOWNERDEAD) {
+                pthread_mutex_consistent(&hdr->mutex);
+                hdr->poisoned = 1;
+                pthread_cond_broadcast(&hdr->not_empty);
+                pthread_cond_broadcast(&hdr->not_full);
+            }
+            return !hdr->poisoned;
+        }
+    };
+
+   public:
+    /**
+     * create the shared memory object name for capacity elements,
+     * replacing any object of that name.
+     * throw runtime_error if it cannot be created.
+     */
+    shm_deque(const char* name, size_t capacity) {
+        size_t blocks = (capacity + block_elements - 1) / block_elements + 2;
+        map_bytes = blocks_offset + blocks * block_stride;
+        ::shm_unlink(name);
+        int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+            throw runtime_error("shm_deque: cannot create shared memory");
+        if (::ftruncate(fd, map_bytes) != 0) {
+            ::close(fd);
+            ::shm_unlink(name);
+            throw runtime_error("shm_deque: cannot size shared memory");
+        }
+        map(fd, true);
+        hdr = new (base) header;
+        hdr->element_bytes = sizeof(T);
+        hdr->block_elements = block_elements;
+        hdr->bytes = map_bytes;
+        hdr->capacity = capacity;
+        pthread_mutexattr_t mattr;
+        pthread_mutexattr_init(&mattr);
+        pthread_mutexattr_setpshared(&mattr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&mattr, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&hdr->mutex, &mattr);
+        pthread_mutexattr_destroy(&mattr);
+        pthread_condattr_t cattr;
+        pthread_condattr_init(&cattr);
+        pthread_condattr_setpshared(&cattr, PTHREAD_PROCESS_SHARED);
+        pthread_cond_init(&hdr->not_empty, &cattr);
+        pthread_cond_init(&hdr->not_full, &cattr);
+        pthread_condattr_destroy(&cattr);
+        empty_out();
+        hdr->ready.store(shm_magic, std::memory_order_release);
+    }
+    /**
+     * open the shared memory object name, created by another process
+     * with the constructor above, waiting for it to be initialized.
+     * throw runtime_error if it does not exist or holds another type.
+     */
+    explicit shm_deque(const char* name) {
+        int fd = ::shm_open(name, O_RDWR, 0600);
+        if (fd < 0)
+            throw runtime_error("shm_deque: cannot open shared memory");
+        struct stat st;
+        // the creator may not have sized it yet
+        for (int tries = 0;; tries++) {
+            if (::fstat(fd, &st) != 0) {
+                ::close(fd);
+                throw runtime_error("shm_deque: cannot stat shared memory");
+            }
+            if (st.st_size)
+                break;
+            if (tries == 100000) {
+                ::close(fd);
+                throw runtime_error("shm_deque: shared memory never sized");
+            }
+            sched_yield();
+        }
+        map_bytes = st.st_size;
+        map(fd, map_bytes >= blocks_offset);
+        hdr = reinterpret_cast<header*>(base);
+        for (int tries = 0;
+             hdr->ready.load(std::memory_order_acquire) != shm_magic; tries++) {
+            if (tries == 100000) {
+                ::munmap(base, map_bytes);
+                throw runtime_error("shm_deque: shared memory never set up");
+            }
+            sched_yield();
+        }
+        if (hdr->element_bytes != sizeof(T) ||
+            hdr->block_elements != block_elements || hdr->bytes != map_bytes) {
+            ::munmap(base, map_bytes);
+            throw runtime_error("shm_deque: element type mismatch");
+        }
+    }
+    shm_deque(const shm_deque& other) = delete;
+    shm_deque& operator=(const shm_deque& other) = delete;
+
+    /**
+     * deconstructor, unmaps the object; the object itself stays until
+     * remove() is called.
+     */
+    ~shm_deque() { ::munmap(base, map_bytes); }
+    /**
+     * remove the object name; processes that have it open keep it.
+     */
+    static void remove(const char* name) { ::shm_unlink(name); }
+    /**
+     * drop all the elements and clear the poisoned mark left by a process
+     * that died holding the mutex, so the deque can be used again.
+     */
+    void reset() {
+        guard lock(hdr, true);
+        empty_out();
+        pthread_cond_broadcast(&hdr->not_full);
+    }
+
+    /**
+     * size and capacity.
+     */
+    size_t size() const {
+        guard lock(hdr);
+        return hdr->total_size;
+    }
+    bool empty() const { return !size(); }
+    size_t capacity() const { return hdr->capacity; }
+
+    /**
+     * copy out a specified element with bound checking.
+     * throw index_out_of_bound if out of bound.
+     */
+    T at(const size_t& pos) const {
+        guard lock(hdr);
+        if (pos >= hdr->total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        // the blocks are full except the ends
+        size_t g = hdr->head_pos + pos;
+        uint64_t off = hdr->head_block;
+        for (size_t k = g / block_elements; k; k--)
+            off = link_at(off)->next;
+        return data_at(off)[g % block_elements];
+    }
+    /**
+     * copy out the first or the last element.
+     * throw container_is_empty when the container is empty.
+     */
+    T front() const {
+        guard lock(hdr);
+        if (!hdr->total_size)
+            throw container_is_empty("front function: container is empty");
+        return data_at(hdr->head_block)[hdr->head_pos];
+    }
+    T back() const {
+        guard lock(hdr);
+        if (!hdr->total_size)
+            throw container_is_empty("back function: container is empty");
+        return data_at(hdr->tail_block)[hdr->tail_pos - 1];
+    }
+
+    /**
+     * push and pop at both ends.
+     * the pushes throw container_is_full and the pops container_is_empty;
+     * the try_ versions return false instead, and the wait_ versions
+     * block until they can go ahead.
+     */
+    void push_back(const T& value) {
+        if (!try_push_back(value))
+            throw container_is_full("push_back function: container is full");
+    }
+    void push_front(const T& value) {
+        if (!try_push_front(value))
+            throw container_is_full("push_front function: container is full");
+    }
+    void pop_front() {
+        slot value;
+        if (!try_pop_front(*value.get()))
+            throw container_is_empty("pop_front function: container is empty");
+    }
+    void pop_back() {
+        slot value;
+        if (!try_pop_back(*value.get()))
+            throw container_is_empty("pop_back function: container is empty");
+    }
+    bool try_push_back(const T& value) {
+        guard lock(hdr);
+        return hdr->total_size < hdr->capacity && (put_back(value), true);
+    }
+    bool try_push_front(const T& value) {
+        guard lock(hdr);
+        return hdr->total_size < hdr->capacity && (put_front(value), true);
+    }
+    bool try_pop_front(T& out) {
+        guard lock(hdr);
+        return hdr->total_size && (take_front(out), true);
+    }
+    bool try_pop_back(T& out) {
+        guard lock(hdr);
+        return hdr->total_size && (take_back(out), true);
+    }
+    void wait_push_back(const T& value) {
+        guard lock(hdr);
+        while (hdr->total_size >= hdr->capacity)
+            lock.wait(&hdr->not_full);
+        put_back(value);
+    }
+    void wait_push_front(const T& value) {
+        guard lock(hdr);
+        while (hdr->total_size >= hdr->capacity)
+            lock.wait(&hdr->not_full);
+        put_front(value);
+    }
+    T wait_pop_front() {
+        guard lock(hdr);
+        while (!hdr->total_size)
+            lock.wait(&hdr->not_empty);
+        slot out;
+        take_front(*out.get());
+        return *out.get();
+    }
+    T wait_pop_back() {
+        guard lock(hdr);
+        while (!hdr->total_size)
+            lock.wait(&hdr->not_empty);
+        slot out;
+        take_back(*out.get());
+        return *out.get();
+    }
+
+    //------------------------------
+    // offsets and blocks, all under the mutex
+    //------------------------------
+    block* link_at(uint64_t off) const {
+        return reinterpret_cast<block*>(base + off);
+    }
+    T* data_at(uint64_t off) const {
+        return reinterpret_cast<T*>(base + off + data_offset);
+    }
+    void map(int fd, bool ok) {
+        void* ptr = ok ? ::mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd, 0)
+                       : MAP_FAILED;
+        ::close(fd);
+        if (ptr == MAP_FAILED)
+            throw runtime_error("shm_deque: cannot map shared memory");
+        base = static_cast<unsigned char*>(ptr);
+    }
+    // no elements, every block on the free list
+    void empty_out() {
+        size_t blocks = (hdr->bytes - blocks_offset) / block_stride;
+        hdr->head_block = hdr->tail_block = 0;
+        hdr->head_pos = hdr->tail_pos = hdr->total_size = 0;
+        hdr->free_block = 0;
+        for (size_t i = blocks; i-- > 0;) {
+            uint64_t off = blocks_offset + i * block_stride;
+            link_at(off)->next = hdr->free_block;
+            hdr->free_block = off;
+        }
+        hdr->poisoned = 0;
+    }
+    // a block from the free list; there is always one while not full
+    uint64_t take_block() {
+        uint64_t off = hdr->free_block;
+        hdr->free_block = link_at(off)->next;
+        link_at(off)->prev = link_at(off)->next = 0;
+        return off;
+    }
+    void drop_block(uint64_t off) {
+        link_at(off)->next = hdr->free_block;
+        hdr->free_block = off;
+    }
+    void put_back(const T& value) {
+        if (!hdr->total_size) {
+            hdr->head_block = hdr->tail_block = take_block();
+            hdr->head_pos = hdr->tail_pos = 0;
+        } else if (hdr->tail_pos == block_elements) {
+            uint64_t off = take_block();
+            link_at(off)->prev = hdr->tail_block;
+            link_at(hdr->tail_block)->next = off;
+            hdr->tail_block = off;
+            hdr->tail_pos = 0;
+        }
+        std::memcpy(data_at(hdr->tail_block) + hdr->tail_pos++, &value,
+                    sizeof(T));
+        ++hdr->total_size;
+        pthread_cond_signal(&hdr->not_empty);
+    }
+    void put_front(const T& value) {
+        if (!hdr->total_size) {
+            hdr->head_block = hdr->tail_block = take_block();
+            hdr->head_pos = hdr->tail_pos = block_elements;
+        } else if (!hdr->head_pos) {
+            uint64_t off = take_block();
+            link_at(off)->next = hdr->head_block;
+            link_at(hdr->head_block)->prev = off;
+            hdr->head_block = off;
+            hdr->head_pos = block_elements;
+        }
+        std::memcpy(data_at(hdr->head_block) + --hdr->head_pos, &value,
+                    sizeof(T));
+        ++hdr->total_size;
+        pthread_cond_signal(&hdr->not_empty);
+    }
+    void take_front(T& out) {
+        std::memcpy(&out, data_at(hdr->head_block) + hdr->head_pos++,
+                    sizeof(T));
+        if (!--hdr->total_size) {
+            drop_block(hdr->head_block);
+            hdr->head_block = hdr->tail_block = 0;
+        } else if (hdr->head_pos == block_elements) {
+            uint64_t next = link_at(hdr->head_block)->next;
+            drop_block(hdr->head_block);
+            hdr->head_block = next;
+            link_at(next)->prev = 0;
+            hdr->head_pos = 0;
+        }
+        pthread_cond_signal(&hdr->not_full);
+    }
+    void take_back(T& out) {
+        std::memcpy(&out, data_at(hdr->tail_block) + --hdr->tail_pos,
+                    sizeof(T));
+        if (!--hdr->total_size) {
+            drop_block(hdr->tail_block);
+            hdr->head_block = hdr->tail_block = 0;
+        } else if (!hdr->tail_pos) {
+            uint64_t prev = link_at(hdr->tail_block)->prev;
+            drop_block(hdr->tail_block);
+            hdr->tail_block = prev;
+            link_at(prev)->next = 0;
+            hdr->tail_pos = block_elements;
+        }
+        pthread_cond_signal(&hdr->not_full);
+    }
+};
+}  // namespace sjtu
+
+#endif
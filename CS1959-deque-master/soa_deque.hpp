@@ -0,0 +1,342 @@
+#ifndef SJTU_SOA_DEQUE_HPP
+#define SJTU_SOA_DEQUE_HPP
+#include "block_map.hpp"
+#include "deque.hpp"
+// elements a block of a soa_deque
+#ifndef SOA_BLOCK_ELEMENTS
+#define SOA_BLOCK_ELEMENTS 1024
+#endif
+
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+namespace sjtu {
+/**
+ * a deque of records stored column by column.
+ * the elements sit in blocks of up to SOA_BLOCK_ELEMENTS, as in deque,
+ * but a block keeps each field in its own array, aligned to a cache
+ * line, so a scan of one field reads only that field.
+ * an element is a std::tuple<Fields...>; at() and the iterators hand out
+ * a tuple of references to its fields, which reads and assigns through.
+ * for_each_segment<I> gives the contiguous run of field I of each block,
+ * for loops the compiler can vectorize.
+ * pushes and pops at both ends are O(1). insert and erase shift the
+ * smaller half of one block, split it when full, and merge it with its
+ * neighbour when both are small.
+ * the fields must be nothrow move constructible; a push builds the whole
+ * record before anything is changed.
+ */
+template <class... Fields>
+class soa_deque {
+    static_assert(sizeof...(Fields) > 0, "soa_deque: no fields");
+    static_assert((std::is_nothrow_move_constructible<Fields>::value && ...),
+                  "soa_deque: fields must be nothrow move constructible");
+
+   public:
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+    template <size_t I>
+    using field = typename std::tuple_element<I, value_type>::type;
+    using columns = std::index_sequence_for<Fields...>;
+
+    static constexpr size_t block_elements = SOA_BLOCK_ELEMENTS;
+    static constexpr size_t column_align = CACHE_LINE;
+    static constexpr size_t align_up(size_t bytes) {
+        return (bytes + column_align - 1) / column_align * column_align;
+    }
+    // byte offset of column I in the storage of a block
+    template <size_t I>
+    static constexpr size_t column_offset() {
+        if constexpr (I == 0)
+            return 0;
+        else
+            return align_up(column_offset<I - 1>() +
+                            block_elements * sizeof(field<I - 1>));
+    }
+    static constexpr size_t block_bytes =
+        column_offset<sizeof...(Fields) - 1>() +
+        block_elements * sizeof(field<sizeof...(Fields) - 1>);
+
+    class block {
+       public:
+        char* storage;
+        // the elements are in slots [head, head + size)
+        size_t head;
+        size_t size = 0;
+
+        // empty, with its elements to start at slot head
+        explicit block(size_t head)
+            : storage(static_cast<char*>(::operator new(
+                  block_bytes, std::align_val_t(column_align)))),
+              head(head) {}
+        ~block() { ::operator delete(storage, std::align_val_t(column_align)); }
+        block(const block& other) = delete;
+        block& operator=(const block& other) = delete;
+
+        template <size_t I>
+        field<I>* column() const {
+            return reinterpret_cast<field<I>*>(storage + column_offset<I>());
+        }
+        reference ref(size_t slot) const { return ref(slot, columns()); }
+        template <size_t... I>
+        reference ref(size_t slot, std::index_sequence<I...>) const {
+            return reference(column<I>()[slot]...);
+        }
+        // move value into the raw slot
+        void construct(size_t slot, value_type&& value) {
+            construct(slot, std::move(value), columns());
+        }
+        template <size_t... I>
+        void construct(size_t slot, value_type&& value,
+                       std::index_sequence<I...>) {
+            (new (column<I>() + slot)
+                 field<I>(std::move(std::get<I>(value))),
+             ...);
+        }
+        void destroy(size_t slot) { destroy(slot, columns()); }
+        template <size_t... I>
+        void destroy(size_t slot, std::index_sequence<I...>) {
+            (column<I>()[slot].~field<I>(), ...);
+        }
+        // move the element in slot src of from into the raw slot dst
+        void relocate(size_t dst, block* from, size_t src) {
+            relocate(dst, from, src, columns());
+        }
+        template <size_t... I>
+        void relocate(size_t dst, block* from, size_t src,
+                      std::index_sequence<I...>) {
+            ((new (column<I>() + dst)
+                  field<I>(std::move(from->template column<I>()[src])),
+              from->template column<I>()[src].~field<I>()),
+             ...);
+        }
+    };
+
+    sized_block_map<block, block_elements> map;
+
+   public:
+    /**
+     * iterators remember their block, so stepping is O(1).
+     * insert and erase invalidate all of them.
+     */
+    using iterator = block_iterator<soa_deque, false>;
+    using const_iterator = block_iterator<soa_deque, true>;
+
+   public:
+    /**
+     * constructors.
+     */
+    soa_deque() {}
+    soa_deque(const soa_deque& other) {
+        for (auto it = other.cbegin(); it != other.cend(); ++it)
+            push_back(value_type(*it));
+    }
+    soa_deque(soa_deque&& other) noexcept { swap(other); }
+
+    /**
+     * deconstructor.
+     */
+    ~soa_deque() { clear(); }
+
+    /**
+     * assignment operators.
+     */
+    soa_deque& operator=(const soa_deque& other) {
+        if (this != &other) {
+            soa_deque tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+    soa_deque& operator=(soa_deque&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+    void swap(soa_deque& other) noexcept { map.swap(other.map); }
+
+    /**
+     * access a specified element with bound checking, as a tuple of
+     * references to its fields. finding the block walks the blocks from
+     * the nearer end.
+     * throw index_out_of_bound if out of bound.
+     */
+    reference at(const size_t& pos) {
+        if (pos >= map.total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        size_t k, j;
+        map.locate(pos, k, j);
+        block* blk = map.block_at(k);
+        return blk->ref(blk->head + j);
+    }
+    const_reference at(const size_t& pos) const {
+        return const_cast<soa_deque*>(this)->at(pos);
+    }
+    reference operator[](const size_t& pos) { return at(pos); }
+    const_reference operator[](const size_t& pos) const { return at(pos); }
+    /**
+     * field I of the element at pos.
+     * throw index_out_of_bound if out of bound.
+     */
+    template <size_t I>
+    field<I>& get(const size_t& pos) {
+        return std::get<I>(at(pos));
+    }
+    template <size_t I>
+    const field<I>& get(const size_t& pos) const {
+        return std::get<I>(at(pos));
+    }
+
+    /**
+     * access the first and the last element.
+     * throw container_is_empty when the container is empty.
+     */
+    reference front() {
+        if (!map.total_size)
+            throw container_is_empty("front function: container is empty");
+        block* blk = map.front();
+        return blk->ref(blk->head);
+    }
+    const_reference front() const {
+        return const_cast<soa_deque*>(this)->front();
+    }
+    reference back() {
+        if (!map.total_size)
+            throw container_is_empty("back function: container is empty");
+        block* blk = map.back();
+        return blk->ref(blk->head + blk->size - 1);
+    }
+    const_reference back() const {
+        return const_cast<soa_deque*>(this)->back();
+    }
+
+    /**
+     * iterators.
+     */
+    iterator begin() { return iterator(this, 0); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator cbegin() const { return const_iterator(this, 0); }
+    iterator end() { return iterator(this, map.total_size); }
+    const_iterator end() const { return const_iterator(this, map.total_size); }
+    const_iterator cend() const { return const_iterator(this, map.total_size); }
+
+    /**
+     * call f(data, n) for the run of field I in each block, in order.
+     */
+    template <size_t I, class F>
+    void for_each_segment(F f) {
+        for (size_t k = 0; k < map.blocks; k++) {
+            block* blk = map.block_at(k);
+            f(blk->template column<I>() + blk->head, blk->size);
+        }
+    }
+    template <size_t I, class F>
+    void for_each_segment(F f) const {
+        for (size_t k = 0; k < map.blocks; k++) {
+            block* blk = map.block_at(k);
+            f((const field<I>*)blk->template column<I>() + blk->head,
+              blk->size);
+        }
+    }
+
+    /**
+     * size.
+     */
+    bool empty() const { return !map.total_size; }
+    size_t size() const { return map.total_size; }
+
+    /**
+     * clear all contents.
+     */
+    void clear() {
+        for (size_t k = 0; k < map.blocks; k++) {
+            block* blk = map.block_at(k);
+            for (size_t i = 0; i < blk->size; i++)
+                blk->destroy(blk->head + i);
+        }
+        map.free_blocks();
+    }
+
+    /**
+     * push and pop at both ends.
+     * throw container_is_empty when popping an empty container.
+     */
+    void push_back(const Fields&... values) {
+        push_back(value_type(values...));
+    }
+    void push_back(value_type value) {
+        size_t slot;
+        map.open_back(slot)->construct(slot, std::move(value));
+    }
+    void push_front(const Fields&... values) {
+        push_front(value_type(values...));
+    }
+    void push_front(value_type value) {
+        size_t slot;
+        map.open_front(slot)->construct(slot, std::move(value));
+    }
+    void pop_back() {
+        if (!map.total_size)
+            throw container_is_empty("pop_back function: container is empty");
+        block* blk = map.back();
+        blk->destroy(blk->head + blk->size - 1);
+        map.close_back();
+    }
+    void pop_front() {
+        if (!map.total_size)
+            throw container_is_empty("pop_front function: container is empty");
+        block* blk = map.front();
+        blk->destroy(blk->head);
+        map.close_front();
+    }
+
+    /**
+     * insert value before pos and return an iterator to it.
+     * a full block is split in two first.
+     * throw index_out_of_bound if pos is out of bound.
+     */
+    iterator insert(const size_t& pos, value_type value) {
+        if (pos > map.total_size)
+            throw index_out_of_bound("insert function: index out of bound");
+        size_t slot;
+        map.open_slot(pos, slot)->construct(slot, std::move(value));
+        return iterator(this, pos);
+    }
+    iterator insert(const_iterator pos, value_type value) {
+        if (pos.check_ptr != this)
+            throw invalid_iterator("insert function: invalid iterator");
+        return insert(pos.pos, std::move(value));
+    }
+    /**
+     * remove the element at pos and return an iterator to the following
+     * one. a block left with under a quarter of its room is merged into
+     * a neighbour when both fit in half a block.
+     * throw index_out_of_bound if pos is out of bound.
+     */
+    iterator erase(const size_t& pos) {
+        if (pos >= map.total_size)
+            throw index_out_of_bound("erase function: index out of bound");
+        size_t k, j;
+        map.locate(pos, k, j);
+        block* blk = map.block_at(k);
+        blk->destroy(blk->head + j);
+        map.close_slot(k, j);
+        return iterator(this, pos);
+    }
+    iterator erase(const_iterator pos) {
+        if (pos.check_ptr != this)
+            throw invalid_iterator("erase function: invalid iterator");
+        return erase(pos.pos);
+    }
+
+    // the element in a slot, for the iterators
+    static reference element(block* blk, size_t slot) { return blk->ref(slot); }
+};
+}  // namespace sjtu
+
+#endif
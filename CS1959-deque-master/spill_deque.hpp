@@ -0,0 +1,263 @@
+#ifndef SJTU_SPILL_DEQUE_HPP
+#define SJTU_SPILL_DEQUE_HPP
+#include "block_map.hpp"
+#include "deque.hpp"
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+namespace sjtu {
+/**
+ * an out-of-core deque for queues larger than memory.
+ * the elements sit in fixed blocks of about BlockBytes. the two end
+ * blocks are always in memory; the interior blocks stay in memory up to
+ * memory_cap bytes in all, past that the least recently used one is
+ * written to a spill file and freed. reading an evicted block faults it
+ * back in, evicting another.
+ * pushes and pops at either end touch only the end blocks and never the
+ * disk, except that popping into an evicted block faults it in.
+ * the blocks are full except the two ends, so at(i) finds its block in O(1).
+ * there is no insert or erase in the middle.
+ * only for raw element types, which are written byte for byte.
+ * a reference returned by at() is invalidated by any later access that
+ * evicts its block.
+ */
+template <class T, size_t BlockBytes = 64 * 1024>
+class spill_deque {
+    static_assert(serializer<T>::raw,
+                  "spill_deque: T must be trivially copyable");
+
+   public:
+    using value_type = T;
+    static constexpr size_t block_elements =
+        BlockBytes / sizeof(T) ? BlockBytes / sizeof(T) : 1;
+    static constexpr size_t block_bytes = block_elements * sizeof(T);
+    static constexpr size_t no_slot = (size_t)-1;
+
+    class block {
+       public:
+        T* data = nullptr;  // nullptr while evicted
+        size_t slot = no_slot;  // place in the spill file, once written
+        bool dirty = true;  // data differs from the copy in the file
+        // the lru list of resident interior blocks, most recent first
+        block* lru_prev = nullptr;
+        block* lru_next = nullptr;
+        bool in_lru = false;
+    };
+
+    fixed_block_map<spill_deque, block, block_elements> map{this};
+
+    int fd = -1;
+    size_t max_resident;
+    mutable size_t resident = 0;
+    mutable std::vector<size_t> free_slots;
+    mutable size_t file_slots = 0;
+    // counters, for tuning memory_cap
+    mutable size_t evictions = 0;
+    mutable size_t faults = 0;
+
+   public:
+    using const_iterator = position_iterator<spill_deque>;
+    using iterator = const_iterator;
+
+   public:
+    /**
+     * spill to a new file at spill_path, keeping about memory_cap bytes
+     * of blocks in memory, never fewer than three blocks.
+     * the file is unlinked as soon as it is open, so it goes away with
+     * the deque or the process.
+     * throw runtime_error if the file cannot be created.
+     */
+    explicit spill_deque(const char* spill_path,
+                         size_t memory_cap = 64 * 1024 * 1024)
+        : max_resident(std::max(memory_cap / block_bytes, (size_t)3)) {
+        fd = ::open(spill_path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0)
+            throw runtime_error("spill_deque: cannot create spill file");
+        ::unlink(spill_path);
+    }
+    spill_deque(const spill_deque& other) = delete;
+    spill_deque& operator=(const spill_deque& other) = delete;
+
+    /**
+     * deconstructor.
+     */
+    ~spill_deque() {
+        map.free_blocks();
+        ::close(fd);
+    }
+
+    /**
+     * access a specified element with bound checking, faulting its block
+     * in if it was evicted.
+     * throw index_out_of_bound if out of bound, runtime_error if the
+     * spill file cannot be read.
+     */
+    const T& at(const size_t& pos) const {
+        if (pos >= map.total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        return map.touch(map.block_of(pos))->data[map.slot_of(pos)];
+    }
+    T& at(const size_t& pos) {
+        if (pos >= map.total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        block* blk = map.touch(map.block_of(pos));
+        written(blk);
+        return blk->data[map.slot_of(pos)];
+    }
+    const T& operator[](const size_t& pos) const { return at(pos); }
+    T& operator[](const size_t& pos) { return at(pos); }
+
+    /**
+     * access the first and the last element, both always in memory.
+     * throw container_is_empty when the container is empty.
+     */
+    const T& front() const {
+        if (!map.total_size)
+            throw container_is_empty("front function: container is empty");
+        return map.front()->data[map.head];
+    }
+    const T& back() const {
+        if (!map.total_size)
+            throw container_is_empty("back function: container is empty");
+        return map.back()->data[map.slot_of(map.total_size - 1)];
+    }
+
+    /**
+     * iterators.
+     */
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator cbegin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+    const_iterator cend() const { return const_iterator(this, size()); }
+
+    /**
+     * size.
+     */
+    bool empty() const { return !map.total_size; }
+    size_t size() const { return map.total_size; }
+    size_t spilled_blocks() const { return map.blocks - resident; }
+
+    /**
+     * clear all contents and empty the spill file.
+     */
+    void clear() {
+        map.free_blocks();
+        free_slots.clear();
+        file_slots = 0;
+        if (::ftruncate(fd, 0) != 0)
+            throw runtime_error("spill_deque: cannot truncate spill file");
+    }
+
+    /**
+     * push and pop at both ends.
+     * a push may evict the block next to the end it opens a block at;
+     * a pop that empties an end block faults in its neighbour.
+     */
+    void push_back(const T& value) {
+        size_t slot;
+        block* blk = map.open_back(slot);
+        std::memcpy(blk->data + slot, &value, sizeof(T));
+    }
+    void push_front(const T& value) {
+        size_t slot;
+        block* blk = map.open_front(slot);
+        std::memcpy(blk->data + slot, &value, sizeof(T));
+    }
+    void pop_back() {
+        if (!map.total_size)
+            throw container_is_empty("pop_back function: container is empty");
+        map.close_back();
+    }
+    void pop_front() {
+        if (!map.total_size)
+            throw container_is_empty("pop_front function: container is empty");
+        map.close_front();
+    }
+
+    //------------------------------
+    // blocks and the spill file, the steps fixed_block_map calls
+    //------------------------------
+    block* new_block() {
+        block* blk = new block;
+        blk->data = new_data();
+        ++resident;
+        return blk;
+    }
+    // the elements of a block, aligned for T
+    static T* new_data() {
+        return static_cast<T*>(
+            ::operator new(block_bytes, std::align_val_t(alignof(T))));
+    }
+    static void free_data(T* data) {
+        ::operator delete(data, std::align_val_t(alignof(T)));
+    }
+    void free_block(block* blk) {
+        if (blk->data) {
+            free_data(blk->data);
+            --resident;
+        }
+        if (blk->slot != no_slot)
+            free_slots.push_back(blk->slot);
+        delete blk;
+    }
+    void written(block* blk) const { blk->dirty = true; }
+    bool over_cap() const { return resident > max_resident; }
+    // fault the block in from its slot
+    void restore(block* blk) const {
+        if (blk->data)
+            return;
+        ++faults;
+        T* data = new_data();
+        if (!transfer(data, blk->slot, false)) {
+            free_data(data);
+            throw runtime_error("spill_deque: cannot read spill file");
+        }
+        blk->data = data;
+        blk->dirty = false;
+        ++resident;
+    }
+    // write the block to a slot unless the file already has it
+    void evict(block* blk) const {
+        if (blk->dirty || blk->slot == no_slot) {
+            if (blk->slot == no_slot) {
+                if (free_slots.empty()) {
+                    blk->slot = file_slots++;
+                } else {
+                    blk->slot = free_slots.back();
+                    free_slots.pop_back();
+                }
+            }
+            if (!transfer(blk->data, blk->slot, true))
+                throw runtime_error("spill_deque: cannot write spill file");
+        }
+        free_data(blk->data);
+        blk->data = nullptr;
+        --resident;
+        ++evictions;
+    }
+    // read or write one block at its slot, retrying short transfers
+    bool transfer(T* data, size_t slot, bool write) const {
+        char* buf = reinterpret_cast<char*>(data);
+        off_t offset = (off_t)slot * block_bytes;
+        for (size_t done = 0; done < block_bytes;) {
+            ssize_t ret = write ? ::pwrite(fd, buf + done, block_bytes - done,
+                                           offset + done)
+                                : ::pread(fd, buf + done, block_bytes - done,
+                                          offset + done);
+            if (ret <= 0)
+                return false;
+            done += ret;
+        }
+        return true;
+    }
+};
+}  // namespace sjtu
+
+#endif
@@ -0,0 +1,370 @@
+#ifndef SJTU_STATIC_DEQUE_HPP
+#define SJTU_STATIC_DEQUE_HPP
+#include "deque.hpp"
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+namespace sjtu {
+/**
+ * a deque with a capacity fixed at compile time.
+ * the elements live in a circular buffer inside the object itself,
+ * so no operation ever touches the heap.
+ * pushing into a full static_deque throws; call to_deque() first
+ * if the queue may outgrow N.
+ */
+template <class T, size_t N>
+class static_deque {
+    static_assert(N > 0, "static_deque: capacity must be positive");
+
+   public:
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type slots[N];
+    size_t head;
+    size_t total_size;
+
+    T* slot(size_t pos) {
+        return reinterpret_cast<T*>(&slots[(head + pos) % N]);
+    }
+    const T* slot(size_t pos) const {
+        return reinterpret_cast<const T*>(&slots[(head + pos) % N]);
+    }
+    // move the value from src into the raw slot dst
+    static void relocate(T* dst, T* src) {
+        new (dst) T(std::move(*src));
+        src->~T();
+    }
+    bool contains(const T* ptr) const {
+        return ptr >= reinterpret_cast<const T*>(slots) &&
+               ptr < reinterpret_cast<const T*>(slots + N);
+    }
+
+   public:
+    class const_iterator;
+    class iterator {
+       public:
+        static_deque* check_ptr;
+        size_t pos;
+
+       public:
+        iterator(static_deque* ptr1 = nullptr, size_t ptr2 = 0)
+            : check_ptr(ptr1), pos(ptr2) {}
+        iterator operator+(const std::ptrdiff_t& n) const {
+            return iterator(check_ptr, pos + n);
+        }
+        iterator operator-(const std::ptrdiff_t& n) const {
+            return iterator(check_ptr, pos - n);
+        }
+        std::ptrdiff_t operator-(const iterator& rhs) const {
+            if (check_ptr != rhs.check_ptr)
+                throw invalid_iterator(
+                    "distance function: not the same list");
+            return (std::ptrdiff_t)pos - (std::ptrdiff_t)rhs.pos;
+        }
+        iterator& operator+=(const std::ptrdiff_t& n) {
+            pos += n;
+            return *this;
+        }
+        iterator& operator-=(const std::ptrdiff_t& n) {
+            pos -= n;
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator iter = *this;
+            ++*this;
+            return iter;
+        }
+        iterator& operator++() {
+            if (!check_ptr || pos >= check_ptr->total_size)
+                throw index_out_of_bound(
+                    "iterator funtion: index out of bound");
+            ++pos;
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator iter = *this;
+            --*this;
+            return iter;
+        }
+        iterator& operator--() {
+            if (!check_ptr || pos == 0)
+                throw index_out_of_bound(
+                    "iterator funtion: index out of bound");
+            --pos;
+            return *this;
+        }
+        T& operator*() const {
+            if (check_ptr && pos < check_ptr->total_size)
+                return *check_ptr->slot(pos);
+            throw invalid_iterator("operator* function: invalid iterator");
+        }
+        T* operator->() const { return &**this; }
+        bool operator==(const iterator& rhs) const {
+            return check_ptr == rhs.check_ptr && pos == rhs.pos;
+        }
+        bool operator==(const const_iterator& rhs) const {
+            return check_ptr == rhs.check_ptr && pos == rhs.pos;
+        }
+        bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+        bool operator!=(const const_iterator& rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    class const_iterator {
+       public:
+        const static_deque* check_ptr;
+        size_t pos;
+
+       public:
+        const_iterator(const static_deque* ptr1 = nullptr, size_t ptr2 = 0)
+            : check_ptr(ptr1), pos(ptr2) {}
+        const_iterator(const iterator& other)
+            : check_ptr(other.check_ptr), pos(other.pos) {}
+        const_iterator operator+(const std::ptrdiff_t& n) const {
+            return const_iterator(check_ptr, pos + n);
+        }
+        const_iterator operator-(const std::ptrdiff_t& n) const {
+            return const_iterator(check_ptr, pos - n);
+        }
+        std::ptrdiff_t operator-(const const_iterator& rhs) const {
+            if (check_ptr != rhs.check_ptr)
+                throw invalid_iterator(
+                    "distance function: not the same list");
+            return (std::ptrdiff_t)pos - (std::ptrdiff_t)rhs.pos;
+        }
+        const_iterator& operator+=(const std::ptrdiff_t& n) {
+            pos += n;
+            return *this;
+        }
+        const_iterator& operator-=(const std::ptrdiff_t& n) {
+            pos -= n;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator iter = *this;
+            ++*this;
+            return iter;
+        }
+        const_iterator& operator++() {
+            if (!check_ptr || pos >= check_ptr->total_size)
+                throw index_out_of_bound(
+                    "iterator funtion: index out of bound");
+            ++pos;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator iter = *this;
+            --*this;
+            return iter;
+        }
+        const_iterator& operator--() {
+            if (!check_ptr || pos == 0)
+                throw index_out_of_bound(
+                    "iterator funtion: index out of bound");
+            --pos;
+            return *this;
+        }
+        const T& operator*() const {
+            if (check_ptr && pos < check_ptr->total_size)
+                return *check_ptr->slot(pos);
+            throw invalid_iterator("operator* function: invalid iterator");
+        }
+        const T* operator->() const { return &**this; }
+        bool operator==(const iterator& rhs) const {
+            return check_ptr == rhs.check_ptr && pos == rhs.pos;
+        }
+        bool operator==(const const_iterator& rhs) const {
+            return check_ptr == rhs.check_ptr && pos == rhs.pos;
+        }
+        bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+        bool operator!=(const const_iterator& rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+   public:
+    /**
+     * constructors.
+     */
+    static_deque() : head(0), total_size(0) {}
+    static_deque(const static_deque& other) : head(0), total_size(0) {
+        for (size_t i = 0; i < other.total_size; i++)
+            push_back(*other.slot(i));
+    }
+
+    /**
+     * deconstructor.
+     */
+    ~static_deque() { clear(); }
+
+    /**
+     * assignment operator.
+     */
+    static_deque& operator=(const static_deque& other) {
+        if (this == &other)
+            return *this;
+        clear();
+        for (size_t i = 0; i < other.total_size; i++)
+            push_back(*other.slot(i));
+        return *this;
+    }
+
+    /**
+     * access a specified element with bound checking.
+     * throw index_out_of_bound if out of bound.
+     */
+    T& at(const size_t& pos) {
+        if (pos >= total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        return *slot(pos);
+    }
+    const T& at(const size_t& pos) const {
+        if (pos >= total_size)
+            throw index_out_of_bound("at function: index_out_of_bound");
+        return *slot(pos);
+    }
+    T& operator[](const size_t& pos) { return at(pos); }
+    const T& operator[](const size_t& pos) const { return at(pos); }
+
+    /**
+     * access the first element.
+     * throw container_is_empty when the container is empty.
+     */
+    const T& front() const {
+        if (!total_size)
+            throw container_is_empty("front function: container is empty");
+        return *slot(0);
+    }
+    /**
+     * access the last element.
+     * throw container_is_empty when the container is empty.
+     */
+    const T& back() const {
+        if (!total_size)
+            throw container_is_empty("back function: container is empty");
+        return *slot(total_size - 1);
+    }
+
+    /**
+     * iterators.
+     */
+    iterator begin() { return iterator(this, 0); }
+    const_iterator cbegin() const { return const_iterator(this, 0); }
+    iterator end() { return iterator(this, total_size); }
+    const_iterator cend() const { return const_iterator(this, total_size); }
+
+    /**
+     * size and capacity.
+     */
+    constexpr bool empty() const { return !total_size; }
+    constexpr size_t size() const { return total_size; }
+    constexpr bool full() const { return total_size == N; }
+    static constexpr size_t capacity() { return N; }
+
+    /**
+     * clear all contents.
+     */
+    void clear() {
+        for (size_t i = 0; i < total_size; i++)
+            slot(i)->~T();
+        head = total_size = 0;
+    }
+
+    /**
+     * insert value before pos, shifting the shorter side.
+     * return an iterator pointing to the inserted value.
+     * throw if the iterator is invalid or the container is full.
+     */
+    iterator insert(iterator pos, const T& value) {
+        if (pos.check_ptr != this || pos.pos > total_size)
+            throw invalid_iterator(
+                "insert function: not pointing to the same list");
+        if (full())
+            throw container_is_full("insert function: container is full");
+        if (contains(&value)) {
+            T tmp(value);
+            return insert(pos, tmp);
+        }
+        size_t idx = pos.pos;
+        if (idx < total_size / 2) {
+            head = (head + N - 1) % N;
+            for (size_t i = 0; i < idx; i++)
+                relocate(slot(i), slot(i + 1));
+        } else {
+            for (size_t i = total_size; i > idx; i--)
+                relocate(slot(i), slot(i - 1));
+        }
+        new (slot(idx)) T(value);
+        ++total_size;
+        return iterator(this, idx);
+    }
+
+    /**
+     * remove the element at pos, shifting the shorter side.
+     * return an iterator pointing to the following element.
+     * throw if the iterator is invalid or points to end().
+     */
+    iterator erase(iterator pos) {
+        if (pos.check_ptr != this)
+            throw invalid_iterator(
+                "erase function: not pointing to the same list");
+        if (pos.pos >= total_size)
+            throw invalid_iterator("erase funciton: erase end");
+        size_t idx = pos.pos;
+        slot(idx)->~T();
+        if (idx < total_size / 2) {
+            for (size_t i = idx; i > 0; i--)
+                relocate(slot(i), slot(i - 1));
+            head = (head + 1) % N;
+        } else {
+            for (size_t i = idx; i + 1 < total_size; i++)
+                relocate(slot(i), slot(i + 1));
+        }
+        --total_size;
+        return iterator(this, idx);
+    }
+
+    /**
+     * push and pop at both ends, all O(1).
+     */
+    void push_back(const T& value) {
+        if (full())
+            throw container_is_full("push_back function: container is full");
+        new (slot(total_size)) T(value);
+        ++total_size;
+    }
+    void pop_back() {
+        if (!total_size)
+            throw container_is_empty("cannot pop_back");
+        slot(--total_size)->~T();
+    }
+    void push_front(const T& value) {
+        if (full())
+            throw container_is_full("push_front function: container is full");
+        new (slot(N - 1)) T(value);
+        head = (head + N - 1) % N;
+        ++total_size;
+    }
+    void pop_front() {
+        if (!total_size)
+            throw container_is_empty("pop_front function: container is empty.");
+        slot(0)->~T();
+        head = (head + 1) % N;
+        --total_size;
+    }
+
+    /**
+     * copy the contents into a heap-backed sjtu::deque,
+     * for a queue that has outgrown N.
+     */
+    deque<T> to_deque() const {
+        deque<T> ret;
+        for (size_t i = 0; i < total_size; i++)
+            ret.push_back(*slot(i));
+        return ret;
+    }
+};
+}  // namespace sjtu
+
+#endif
@@ -0,0 +1,202 @@
+// deque<bool> and bit_deque: values packed a few bits each into words.
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241228);
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.cbegin(); it != test.cend(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+// blocks are neither empty nor over full, and hold all the elements
+template <typename Deque>
+bool isSound(Deque& deq) {
+    size_t sum = 0;
+    for (size_t k = 0; k < deq.map.blocks; k++) {
+        auto* blk = deq.map.block_at(k);
+        if (!blk->size || blk->head + blk->size > deq.block_elements)
+            return false;
+        sum += blk->size;
+    }
+    return sum == deq.size();
+}
+
+// every operation against std::deque, with values below limit
+template <typename T, typename Deque>
+bool randomTest(int ops, uint32_t limit) {
+    std::deque<T> ans;
+    Deque deq;
+    for (int i = 0; i < ops; i++) {
+        int op = randnum() % 12;
+        T v = (T)(randnum() % limit);
+        size_t pos = randnum() % (ans.size() + 1);
+        if (op < 3 || ans.empty()) {
+            ans.push_back(v), deq.push_back(v);
+        } else if (op < 6) {
+            ans.push_front(v), deq.push_front(v);
+        } else if (op < 7) {
+            ans.pop_back(), deq.pop_back();
+        } else if (op < 8) {
+            ans.pop_front(), deq.pop_front();
+        } else if (op < 10) {
+            ans.insert(ans.begin() + pos, v);
+            if (*deq.insert(pos, v) != v)
+                return false;
+        } else {
+            pos %= ans.size();
+            ans.erase(ans.begin() + pos);
+            deq.erase(deq.cbegin() + pos);
+        }
+        if (ans.size() != deq.size() ||
+            (!ans.empty() && (ans.front() != deq.front() ||
+                              ans.back() != deq.back())))
+            return false;
+        if (i % 5000 == 0 && (!isEqual(ans, deq) || !isSound(deq)))
+            return false;
+    }
+    return isEqual(ans, deq) && isSound(deq);
+}
+
+bool boolTest() {
+    return randomTest<bool, sjtu::deque<bool>>(200000, 2) &&
+           randomTest<bool, sjtu::deque<bool, 8>>(20000, 2);
+}
+
+bool smallIntTest() {
+    return randomTest<uint8_t, sjtu::bit_deque<4>>(100000, 16) &&
+           randomTest<uint8_t, sjtu::bit_deque<8>>(100000, 256) &&
+           randomTest<uint16_t, sjtu::bit_deque<12>>(100000, 4096) &&
+           randomTest<uint16_t, sjtu::bit_deque<16>>(100000, 65536) &&
+           randomTest<uint32_t, sjtu::bit_deque<27>>(50000, 1u << 27);
+}
+
+// the proxies read and write the packed bits
+bool referenceTest() {
+    sjtu::deque<bool> flags;
+    for (int i = 0; i < 100000; i++)
+        flags.push_back(i % 3 == 0);
+    flags[1] = true;
+    flags.at(3) = flags[4];
+    for (auto it = flags.begin(); it != flags.end(); it += 1000)
+        *it = false;
+    const sjtu::deque<bool>& c = flags;
+    bool ok = c[1] && !c[3] && !c[0] && c[6] && !c[3000];
+    sjtu::bit_deque<12> deq;
+    for (int i = 0; i < 10000; i++)
+        deq.push_front(i % 4096);
+    deq[5] = 4095;
+    deq[6] = deq[5];
+    return ok && deq[5] == 4095 && deq[6] == 4095 && deq[7] == (9992 % 4096);
+}
+
+// count against a loop, with blocks that start mid-word
+bool countTest() {
+    sjtu::deque<bool> flags;
+    size_t expect = 0;
+    for (int i = 0; i < 300000; i++) {
+        bool v = randnum() % 5 == 0;
+        expect += v;
+        i % 2 ? flags.push_back(v) : flags.push_front(v);
+    }
+    if (flags.count() != expect)
+        return false;
+    for (int i = 0; i < 1000; i++) {
+        size_t pos = randnum() % flags.size();
+        expect -= flags[pos];
+        flags.erase(pos);
+    }
+    size_t loop = 0;
+    for (auto it = flags.cbegin(); it != flags.cend(); ++it)
+        loop += *it;
+    return flags.count() == expect && loop == expect;
+}
+
+// a million flags fit in a little over 125 kilobytes
+bool memoryTest() {
+    sjtu::deque<bool> flags;
+    for (int i = 0; i < 1000000; i++)
+        flags.push_back(i % 7 == 0);
+    sjtu::deque<bool> copy(flags), moved;
+    moved = std::move(copy);
+    swap(moved, copy);
+    return flags.memory_bytes() < 1000000 / 8 * 11 / 10 &&
+           copy.count() == flags.count() && moved.empty();
+}
+
+bool exceptionTest() {
+    int caught = 0;
+    sjtu::bit_deque<4> deq;
+    try {
+        deq.push_back(16);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    try {
+        deq.pop_front();
+    } catch (sjtu::container_is_empty&) {
+        ++caught;
+    }
+    deq.push_back(15);
+    try {
+        deq[0] = 17;
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    try {
+        deq.insert(2, 1);
+    } catch (sjtu::index_out_of_bound&) {
+        ++caught;
+    }
+    try {
+        *deq.end();
+    } catch (sjtu::invalid_iterator&) {
+        ++caught;
+    }
+    return caught == 5 && deq.size() == 1 && deq.front() == 15;
+}
+
+int main() {
+    bool (*testFunc[])() = {boolTest,  smallIntTest, referenceTest,
+                            countTest, memoryTest,   exceptionTest};
+
+    const char* testMessage[] = {
+        "Testing deque<bool>...",
+        "Testing small integers...",
+        "Testing references...",
+        "Testing count...",
+        "Testing memory...",
+        "Testing exceptions...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
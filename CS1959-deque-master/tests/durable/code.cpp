@@ -0,0 +1,172 @@
+// durable_deque: a queue in a log directory that survives a crash.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "class-bint.hpp"
+#include "deque.hpp"
+#include "durable_deque.hpp"
+
+std::default_random_engine randnum(20241207);
+
+static const char* dir = "deque_durable";
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.cbegin(); it != test.cend(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+size_t segmentFiles() {
+    size_t count = 0;
+    for (auto& entry : std::filesystem::directory_iterator(dir))
+        count += entry.path().extension() == ".log";
+    return count;
+}
+
+bool reopenTest() {
+    std::filesystem::remove_all(dir);
+    std::deque<int> ans;
+    for (int round = 0; round < 5; round++) {
+        sjtu::durable_deque<int> deq(dir, 16, 4096);
+        if (!isEqual(ans, deq))
+            return false;
+        for (int i = 0; i < 3000; i++) {
+            if (randnum() % 3 || ans.empty()) {
+                int x = randnum();
+                ans.push_back(x), deq.push_back(x);
+            } else {
+                ans.pop_front(), deq.pop_front();
+            }
+        }
+    }
+    sjtu::durable_deque<int> deq(dir);
+    return isEqual(ans, deq);
+}
+
+// a child process pushes and pops, commits, then dies with some changes
+// still pending; exactly the committed ones must come back
+bool crashTest() {
+    std::filesystem::remove_all(dir);
+    pid_t pid = fork();
+    if (!pid) {
+        sjtu::durable_deque<long long> deq(dir, 1000000, 4096);
+        for (long long i = 0; i < 10000; i++)
+            deq.push_back(i * i);
+        for (int i = 0; i < 2500; i++)
+            deq.pop_front();
+        deq.commit();
+        for (long long i = 0; i < 500; i++)
+            deq.push_back(-1), deq.pop_front();
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    sjtu::durable_deque<long long> deq(dir);
+    if (deq.size() != 7500)
+        return false;
+    for (long long i = 0; i < 7500; i++)
+        if (deq[i] != (i + 2500) * (i + 2500))
+            return false;
+    return true;
+}
+
+// garbage at the end of the log is cut off, and the queue goes on
+bool tornTest() {
+    std::filesystem::remove_all(dir);
+    {
+        sjtu::durable_deque<int> deq(dir, 1);
+        for (int i = 0; i < 100; i++)
+            deq.push_back(i);
+    }
+    std::string last;
+    for (auto& entry : std::filesystem::directory_iterator(dir))
+        if (entry.path().extension() == ".log")
+            last = std::max(last, entry.path().string());
+    std::ofstream(last, std::ios::binary | std::ios::app) << "\x09\0\0\0torn";
+    {
+        sjtu::durable_deque<int> deq(dir, 1);
+        if (deq.size() != 100 || deq.back() != 99)
+            return false;
+        deq.push_back(100);
+    }
+    sjtu::durable_deque<int> deq(dir);
+    return deq.size() == 101 && deq.back() == 100;
+}
+
+// consumed segments are deleted
+bool segmentTest() {
+    std::filesystem::remove_all(dir);
+    sjtu::durable_deque<int> deq(dir, 64, 1024);
+    for (int i = 0; i < 20000; i++)
+        deq.push_back(i);
+    size_t before = segmentFiles();
+    for (int i = 0; i < 19900; i++)
+        deq.pop_front();
+    deq.commit();
+    return before > 100 && segmentFiles() <= 2 && deq.front() == 19900;
+}
+
+bool bintTest() {
+    std::filesystem::remove_all(dir);
+    std::deque<Util::Bint> ans;
+    {
+        sjtu::durable_deque<Util::Bint> deq(dir, 8);
+        for (int i = 0; i < 500; i++) {
+            Util::Bint x = Util::Bint((long long)randnum() - (1LL << 30)) *
+                           Util::Bint((long long)randnum());
+            ans.push_back(x), deq.push_back(x);
+        }
+        for (int i = 0; i < 100; i++)
+            ans.pop_front(), deq.pop_front();
+    }
+    sjtu::durable_deque<Util::Bint> deq(dir);
+    bool ok = isEqual(ans, deq);
+    std::filesystem::remove_all(dir);
+    return ok;
+}
+
+int main() {
+    bool (*testFunc[])() = {reopenTest, crashTest, tornTest, segmentTest,
+                            bintTest};
+
+    const char* testMessage[] = {
+        "Testing reopening...",
+        "Testing a crash...",
+        "Testing a torn record...",
+        "Testing segment deletion...",
+        "Testing Bint elements...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        fflush(stdout);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+// the exceptions carry a static message and an error code,
+// and throwing one does not allocate.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "exceptions.hpp"
+#include "static_deque.hpp"
+
+static size_t allocations = 0;
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+template <class Exception, class Func>
+bool throws(Func func, sjtu::error_code ec, const char* message) {
+    try {
+        func();
+    } catch (const Exception& e) {
+        return e.code() == ec && !std::strcmp(e.what(), message);
+    } catch (...) {
+    }
+    return false;
+}
+
+bool typeTest() {
+    sjtu::deque<int> deq, other;
+    for (int i = 0; i < 10; i++)
+        deq.push_back(i);
+    sjtu::static_deque<int, 2> fixed;
+    fixed.push_back(1), fixed.push_back(2);
+    return throws<sjtu::index_out_of_bound>(
+               [&] { deq.at(10); }, sjtu::error_code::index_out_of_bound,
+               "at function: index_out_of_bound") &&
+           throws<sjtu::container_is_empty>(
+               [&] { other.pop_front(); }, sjtu::error_code::container_is_empty,
+               "pop_front function: container is empty.") &&
+           throws<sjtu::container_is_empty>(
+               [&] { other.back(); }, sjtu::error_code::container_is_empty,
+               "back function: container is empty") &&
+           throws<sjtu::invalid_iterator>(
+               [&] { deq.erase(other.begin()); },
+               sjtu::error_code::invalid_iterator,
+               "erase function: not pointing to the same list") &&
+           throws<sjtu::invalid_iterator>(
+               [&] { *deq.end(); }, sjtu::error_code::invalid_iterator,
+               "operator* function: invalid iterator") &&
+           throws<sjtu::container_is_full>(
+               [&] { fixed.push_front(0); }, sjtu::error_code::container_is_full,
+               "push_front function: container is full");
+}
+
+bool baseTest() {
+    sjtu::deque<Diamond::Matrix<double>> deq;
+    int successCounter = 0;
+    try {
+        deq.front();
+    } catch (const sjtu::exception& e) {
+        successCounter += !std::strcmp(e.kind(), "container_is_empty");
+    }
+    try {
+        deq.at(0);
+    } catch (const std::exception& e) {
+        successCounter += !std::strcmp(e.what(), "at function: index_out_of_bound");
+    }
+    try {
+        throw sjtu::runtime_error();
+    } catch (const sjtu::exception& e) {
+        successCounter += e.code() == sjtu::error_code::runtime_error;
+    }
+    sjtu::index_out_of_bound copy("copied");
+    sjtu::exception base = copy;
+    return successCounter == 3 && !std::strcmp(base.what(), "copied") &&
+           base.code() == sjtu::error_code::index_out_of_bound;
+}
+
+// the exception object itself comes from the runtime, not operator new
+bool allocationTest() {
+    sjtu::deque<int> deq;
+    for (int i = 0; i < FLAT_CAPACITY + 10; i++)
+        deq.push_back(i);
+    size_t before = allocations, caught = 0;
+    for (int i = 0; i < 1000; i++) {
+        try {
+            deq.at(deq.size() + i);
+        } catch (const sjtu::exception& e) {
+            caught += e.code() == sjtu::error_code::index_out_of_bound;
+        }
+        try {
+            ++deq.end();
+        } catch (const sjtu::exception& e) {
+            caught += e.code() == sjtu::error_code::index_out_of_bound;
+        }
+    }
+    return caught == 2000 && allocations == before;
+}
+
+int main() {
+    bool (*testFunc[])() = {typeTest, baseTest, allocationTest};
+
+    const char* testMessage[] = {
+        "Testing exception types...",
+        "Testing base class...",
+        "Testing allocation...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+// the deque switches between the flat ring and the block list by usage.
+
+#include <cstdio>
+#include <deque>
+#include <random>
+
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241019);
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); ++it, ++i)
+        if (*it != ans[i])
+            return false;
+    for (int k = 0; k < 1000 && !ans.empty(); k++) {
+        size_t pos = randnum() % ans.size();
+        if (test[pos] != ans[pos])
+            return false;
+    }
+    return ans.empty() ||
+           (test.front() == ans.front() && test.back() == ans.back());
+}
+
+bool queueTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    // a push/pop workload stays in the ring however long it runs
+    for (int i = 0; i < 1000000; i++) {
+        int x = randnum();
+        ans.push_back(x);
+        deq.push_back(x);
+        if (ans.size() > 5000) {
+            ans.pop_front();
+            deq.pop_front();
+        }
+    }
+    return deq.flat && isEqual(ans, deq);
+}
+
+bool sizeTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    for (int i = 0; i < FLAT_CAPACITY + 100; i++) {
+        int x = randnum();
+        ans.push_front(x);
+        deq.push_front(x);
+    }
+    if (deq.flat || !isEqual(ans, deq))
+        return false;
+    while (ans.size() > FLAT_CAPACITY / 2) {
+        ans.pop_back();
+        deq.pop_back();
+    }
+    // still above the lower threshold
+    if (deq.flat || !isEqual(ans, deq))
+        return false;
+    while (ans.size() > FLAT_CAPACITY / 8) {
+        ans.pop_front();
+        deq.pop_front();
+    }
+    return deq.flat && isEqual(ans, deq);
+}
+
+bool middleTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    for (int i = 0; i < 20000; i++) {
+        ans.push_back(i);
+        deq.push_back(i);
+    }
+    for (int i = 0; i < 2000; i++) {
+        size_t pos = randnum() % (ans.size() + 1);
+        ans.insert(ans.begin() + pos, i);
+        deq.insert(deq.begin() + pos, i);
+    }
+    if (deq.flat || !isEqual(ans, deq))
+        return false;
+    // once the middle traffic stops and the deque shrinks, it goes flat
+    for (int i = 0; i < 17000; i++) {
+        ans.pop_back();
+        deq.pop_back();
+    }
+    for (int i = 0; i < 5000; i++) {
+        ans.push_back(i);
+        deq.push_back(i);
+        ans.pop_front();
+        deq.pop_front();
+    }
+    return deq.flat && isEqual(ans, deq);
+}
+
+bool mixedTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    for (int i = 0; i < 300000; i++) {
+        int x = randnum();
+        int phase = i / 50000 % 2;
+        size_t pos = randnum() % (ans.size() + 1);
+        switch (randnum() % (phase ? 4 : 6)) {
+            case 0:
+                ans.push_back(x);
+                deq.push_back(x);
+                break;
+            case 1:
+                ans.push_front(x);
+                deq.push_front(x);
+                break;
+            case 2:
+                if (!ans.empty()) {
+                    ans.pop_back();
+                    deq.pop_back();
+                }
+                break;
+            case 3:
+                if (!ans.empty()) {
+                    ans.pop_front();
+                    deq.pop_front();
+                }
+                break;
+            case 4: {
+                auto it = deq.insert(deq.begin() + pos, x);
+                ans.insert(ans.begin() + pos, x);
+                if (*it != x || it - deq.begin() != pos)
+                    return false;
+                break;
+            }
+            case 5:
+                if (pos < ans.size()) {
+                    auto it = deq.erase(deq.begin() + pos);
+                    ans.erase(ans.begin() + pos);
+                    if (pos < ans.size() ? *it != ans[pos] : it != deq.end())
+                        return false;
+                }
+                break;
+        }
+        if (i % 10000 == 0) {
+            sjtu::deque<int> copy(deq);
+            if (!isEqual(ans, copy))
+                return false;
+        }
+    }
+    return isEqual(ans, deq);
+}
+
+int main() {
+    bool (*testFunc[])() = {queueTest, sizeTest, middleTest, mixedTest};
+
+    const char* testMessage[] = {
+        "Testing queue workload...",
+        "Testing size threshold...",
+        "Testing middle inserts...",
+        "Testing mixed workload...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,224 @@
+// deque<T, InlineN>: the first InlineN elements stay inside the object.
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241019);
+
+static size_t allocations = 0;
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+static const int INLINE_N = 64;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size() || ans.empty() != test.empty())
+        return false;
+    for (size_t i = 0; i < ans.size(); i++)
+        if (!(ans[i] == test[i]) || !(ans.at(i) == *(test.begin() + i)))
+            return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+bool smallTest() {
+    std::deque<int> ans;
+    sjtu::deque<int, INLINE_N> deq;
+    for (int i = 0; i < 100000; i++) {
+        int x = randnum();
+        size_t pos = randnum() % (ans.size() + 1);
+        switch (randnum() % 6) {
+            case 0:
+                if (ans.size() < INLINE_N)
+                    ans.push_back(x), deq.push_back(x);
+                break;
+            case 1:
+                if (ans.size() < INLINE_N)
+                    ans.push_front(x), deq.push_front(x);
+                break;
+            case 2:
+                if (!ans.empty())
+                    ans.pop_back(), deq.pop_back();
+                break;
+            case 3:
+                if (!ans.empty())
+                    ans.pop_front(), deq.pop_front();
+                break;
+            case 4:
+                if (ans.size() < INLINE_N) {
+                    ans.insert(ans.begin() + pos, x);
+                    deq.insert(deq.begin() + pos, x);
+                }
+                break;
+            case 5:
+                if (pos < ans.size()) {
+                    ans.erase(ans.begin() + pos);
+                    deq.erase(deq.begin() + pos);
+                }
+                break;
+        }
+        if (i % 1000 == 0 && !isEqual(ans, deq))
+            return false;
+    }
+    return isEqual(ans, deq);
+}
+
+bool growTest() {
+    std::deque<int> ans;
+    sjtu::deque<int, INLINE_N> deq;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 20000; i++) {
+            int x = randnum();
+            if (randnum() % 2)
+                ans.push_back(x), deq.push_back(x);
+            else
+                ans.push_front(x), deq.push_front(x);
+            if (i % 7 == 0) {
+                size_t pos = randnum() % ans.size();
+                ans.insert(ans.begin() + pos, x);
+                deq.insert(deq.begin() + pos, x);
+            }
+        }
+        if (!isEqual(ans, deq))
+            return false;
+        sjtu::deque<int, INLINE_N> copy(deq);
+        if (!isEqual(ans, copy))
+            return false;
+        deq.clear();
+        ans.clear();
+        deq.push_back(round);
+        ans.push_back(round);
+    }
+    return isEqual(ans, deq);
+}
+
+bool noHeapTest() {
+    sjtu::deque<Integer, INLINE_N> deq;
+    size_t before = allocations;
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < INLINE_N - 1; i++)
+            round % 2 ? deq.push_back(Integer(i)) : deq.push_front(Integer(i));
+        auto it = deq.erase(deq.begin() + INLINE_N / 2);
+        deq.insert(it, Integer(round));
+        deq.insert(deq.end(), Integer(round));
+        sjtu::deque<Integer, INLINE_N> copy;
+        copy = deq;
+        while (!copy.empty())
+            copy.pop_front();
+        deq.clear();
+    }
+    return allocations == before;
+}
+
+bool matrixTest() {
+    std::vector<Diamond::Matrix<double>> ans;
+    sjtu::deque<Diamond::Matrix<double>, 4> deq;
+    for (int i = 0; i < 200; i++) {
+        ans.push_back(Diamond::Matrix<double>(i % 5 + 1, i % 7 + 1, i * 0.5));
+        deq.push_back(ans.back());
+        if (i == 2 || i == 150) {
+            sjtu::deque<Diamond::Matrix<double>, 4> copy = deq;
+            deq = copy;
+        }
+    }
+    for (int i = 0; i < 200; i++)
+        if (!(ans[i] == deq[i]))
+            return false;
+    return true;
+}
+
+bool errorTest() {
+    sjtu::deque<int, INLINE_N> deq, other;
+    int successCounter = 0;
+    try {
+        deq.front();
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.pop_front();
+    } catch (...) {
+        successCounter++;
+    }
+    for (int i = 0; i < 10; i++)
+        deq.push_back(i);
+    try {
+        deq.at(10);
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        *deq.end();
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        *--deq.begin();
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.insert(other.begin(), 0);
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.erase(deq.end());
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.begin() - other.begin();
+    } catch (...) {
+        successCounter++;
+    }
+    return successCounter == 8;
+}
+
+int main() {
+    bool (*testFunc[])() = {smallTest, growTest, noHeapTest, matrixTest,
+                            errorTest};
+
+    const char* testMessage[] = {
+        "Testing inline operations...", "Testing growing past inline...",
+        "Testing heap usage...",        "Testing matrix...",
+        "Testing errors...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+// positions are 64-bit: iterator offsets and distances are ptrdiff_t.
+// set DEQUE_LARGE_TEST to also fill a deque of chars past 2^32 elements,
+// which needs about 4.5 GB of memory; the ring may hold that many.
+// a block deque that large would take a node and a heap char for every
+// element, over 250 GB, so the block test below fakes its first block.
+
+#define FLAT_CAPACITY ((size_t)1 << 34)
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <type_traits>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241127);
+
+static_assert(std::is_same<decltype(sjtu::deque<int>::iterator() -
+                                    sjtu::deque<int>::iterator()),
+                           std::ptrdiff_t>::value,
+              "iterator distance must be ptrdiff_t");
+static_assert(std::is_same<decltype(sjtu::deque<int>::const_iterator()
+                                        .get_step()),
+                           std::ptrdiff_t>::value,
+              "positions must be ptrdiff_t");
+
+// offsets that do not fit in an int used to wrap around silently
+template <class Deque>
+bool wideOffset(Deque& deq) {
+    const std::ptrdiff_t far = (std::ptrdiff_t)1 << 32;
+    int successCounter = 0;
+    try {
+        deq.begin() + far;
+    } catch (const sjtu::index_out_of_bound&) {
+        successCounter++;
+    }
+    try {
+        deq.cbegin() + (far + 1);
+    } catch (const sjtu::index_out_of_bound&) {
+        successCounter++;
+    }
+    try {
+        auto it = deq.end();
+        it -= far;
+    } catch (const sjtu::index_out_of_bound&) {
+        successCounter++;
+    }
+    try {
+        deq.at(far + 2);
+    } catch (const sjtu::index_out_of_bound&) {
+        successCounter++;
+    }
+    return successCounter == 4;
+}
+
+bool offsetTest() {
+    sjtu::deque<int> flat, blocks;
+    for (int i = 0; i < 10000; i++)
+        flat.push_back(i), blocks.push_back(i);
+    // middle inserts turn the second deque into blocks
+    for (int i = 0; i < 200; i++)
+        blocks.insert(blocks.begin() + blocks.size() / 2, -i);
+    return flat.flat && !blocks.flat && wideOffset(flat) && wideOffset(blocks) &&
+           blocks.end() - blocks.begin() == (std::ptrdiff_t)blocks.size() &&
+           blocks.cbegin() - blocks.cend() == -(std::ptrdiff_t)blocks.size();
+}
+
+// positions past 2^32 in block mode: the first block claims 2^32 more
+// elements than it holds. get_step and quick_move only add up the sizes
+// of the blocks they pass, so positions behind it come out 2^32 too far
+// unless that arithmetic is 64-bit all the way.
+bool blockTest() {
+    sjtu::deque<int> deq;
+    std::deque<int> ans;
+    for (int i = 0; i < 10000; i++)
+        deq.push_back(i), ans.push_back(i);
+    for (int i = 0; i < 200; i++) {
+        deq.insert(deq.begin() + deq.size() / 2, -i);
+        ans.insert(ans.begin() + ans.size() / 2, -i);
+    }
+    if (deq.flat)
+        return false;
+    const size_t fake = (size_t)1 << 32;
+    const size_t first = deq.list.head->val_ptr->size;
+    deq.list.head->val_ptr->size += fake;
+    deq.total_size += fake;
+    const sjtu::deque<int>& cdeq = deq;
+    bool ok = true;
+    for (size_t r = first; r < ans.size() && ok; r += 997) {
+        const std::ptrdiff_t pos = fake + r;
+        auto it = deq.begin() + pos;
+        auto cit = cdeq.cbegin() + pos;
+        ok = *it == ans[r] && *cit == ans[r] && deq.at(pos) == ans[r] &&
+             it.get_step() == pos && it - deq.begin() == pos &&
+             cdeq.cend() - cit == (std::ptrdiff_t)(deq.size() - pos) &&
+             *(it - (std::ptrdiff_t)(r - first)) == ans[first];
+        it += 3;
+        it -= 3;
+        ok = ok && *it == ans[r];
+    }
+    ok = ok && *(deq.end() - 1) == ans.back() &&
+         deq.end() - deq.begin() == (std::ptrdiff_t)deq.size();
+    deq.list.head->val_ptr->size -= fake;
+    deq.total_size -= fake;
+    return ok;
+}
+
+bool largeTest() {
+    const size_t n = ((size_t)1 << 32) + 1000;
+    sjtu::deque<char> deq;
+    deq.reserve(n);
+    for (size_t i = 0; i < n; i++)
+        deq.push_back((char)(i % 127));
+    const size_t pos = ((size_t)1 << 32) + 7;
+    auto it = deq.begin() + (std::ptrdiff_t)pos;
+    const sjtu::deque<char>& cdeq = deq;
+    if (deq.size() != n || *it != (char)(pos % 127) ||
+        deq.at(pos) != (char)(pos % 127) || cdeq[n - 1] != (char)((n - 1) % 127) ||
+        it - deq.begin() != (std::ptrdiff_t)pos ||
+        deq.end() - it != (std::ptrdiff_t)(n - pos) ||
+        *(cdeq.cend() - 1) != (char)((n - 1) % 127))
+        return false;
+    it += 900;
+    it -= (std::ptrdiff_t)pos;
+    if (*it != (char)(900 % 127))
+        return false;
+    deq.pop_front();
+    return deq.front() == 1 &&
+           deq.try_at(n - 2).value() == (char)((n - 1) % 127);
+}
+
+int main() {
+    bool (*testFunc[])() = {offsetTest, blockTest, largeTest};
+
+    const char* testMessage[] = {
+        "Testing wide offsets...",
+        "Testing block positions past 2^32...",
+        "Testing positions past 2^32...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i] == largeTest && !std::getenv("DEQUE_LARGE_TEST")) {
+            printf("Skipped, set DEQUE_LARGE_TEST to run\n");
+            continue;
+        }
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,307 @@
+// load_text from istreams, file descriptors and files, and deque::append.
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "class-bint.hpp"
+#include "class-integer.hpp"
+#include "deque.hpp"
+#include "text_loader.hpp"
+
+std::default_random_engine randnum(20241117);
+
+static const int N = FLAT_CAPACITY + 10000;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+// the reference: the same text through operator>>
+template <typename T>
+std::deque<T> readAll(const std::string& text) {
+    std::istringstream is(text);
+    std::deque<T> ret;
+    T value;
+    while (is >> value)
+        ret.push_back(value);
+    return ret;
+}
+
+// n values, separated by runs of mixed whitespace
+template <typename Make>
+std::string makeText(int n, Make make) {
+    const char* spaces[] = {" ", "\n", "  \t", "\r\n", " \n\n "};
+    std::ostringstream os;
+    os << "\n ";
+    for (int i = 0; i < n; i++)
+        os << make(i) << spaces[randnum() % 5];
+    return os.str();
+}
+
+template <typename T>
+bool streamTest(const std::string& text, size_t chunk_bytes) {
+    std::istringstream is(text);
+    sjtu::deque<T> x;
+    x.push_back(T(7));
+    std::deque<T> a = readAll<T>(text);
+    a.push_front(T(7));
+    size_t count = sjtu::load_text(x, is, chunk_bytes);
+    return count == a.size() - 1 && isEqual(a, x);
+}
+
+bool intTest() {
+    std::string text = makeText(N, [](int) {
+        int v = (int)randnum();
+        return randnum() % 4 ? v : -v;
+    });
+    return streamTest<int>(text, 1 << 20) && streamTest<int>(text, 4096) &&
+           streamTest<long long>(text, 1 << 16);
+}
+
+bool doubleTest() {
+    std::string text = makeText(N / 4, [](int i) {
+        std::ostringstream os;
+        os.precision(17);
+        os << (randnum() % 2 ? 1 : -1) * (double)randnum() / (i + 1);
+        return os.str();
+    });
+    return streamTest<double>(text, 1 << 12) && streamTest<double>(text, 7);
+}
+
+// tiny chunks cut almost every token in two
+bool boundaryTest() {
+    std::string text = makeText(2000, [](int i) { return i * 7919; });
+    for (size_t chunk : {1, 2, 3, 7, 16})
+        if (!streamTest<int>(text, chunk))
+            return false;
+    return streamTest<int>("", 8) && streamTest<int>("  \n ", 2) &&
+           streamTest<int>("42", 1) && streamTest<int>("+5 -6", 3);
+}
+
+bool bintTest() {
+    std::string text = makeText(3000, [](int) {
+        std::string s = randnum() % 2 ? "-" : "";
+        s += std::to_string(randnum() % 9 + 1);
+        for (int len = randnum() % 60; len; len--)
+            s += std::to_string(randnum() % 10);
+        return s;
+    });
+    return streamTest<Util::Bint>(text, 1 << 10) &&
+           streamTest<Util::Bint>(text, 13);
+}
+
+bool fdTest() {
+    std::string text = makeText(N, [](int i) { return N - i; });
+    std::deque<int> a = readAll<int>(text);
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    if (fork() == 0) {
+        close(fds[0]);
+        for (size_t pos = 0; pos < text.size();) {
+            ssize_t got = write(fds[1], text.data() + pos,
+                                std::min(text.size() - pos, (size_t)1000));
+            if (got <= 0)
+                _exit(1);
+            pos += got;
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    sjtu::deque<int> x;
+    size_t count = sjtu::load_text(x, fds[0], 1 << 14);
+    close(fds[0]);
+    return count == a.size() && isEqual(a, x);
+}
+
+bool fileTest() {
+    std::string text = makeText(N, [](int i) { return i % 1000 - 500; });
+    const char* path = "loader_test.txt";
+    FILE* file = fopen(path, "w");
+    fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+    std::deque<int> a = readAll<int>(text);
+    sjtu::deque<int> x;
+    size_t count = sjtu::load_text(x, path);
+    remove(path);
+    if (count != a.size() || !isEqual(a, x))
+        return false;
+    try {
+        sjtu::load_text(x, "no_such_file.txt");
+    } catch (sjtu::runtime_error&) {
+        return x.size() == a.size();
+    }
+    return false;
+}
+
+// a bad token throws, after the values before it
+bool exceptionTest() {
+    const char* bad[] = {"1 2 x3 4", "1 2 3.5", "1 99999999999", "- 1"};
+    size_t good[] = {2, 2, 1, 0};
+    for (int i = 0; i < 4; i++) {
+        std::istringstream is(bad[i]);
+        sjtu::deque<int> x;
+        try {
+            sjtu::load_text(x, is, 3);
+            return false;
+        } catch (sjtu::runtime_error&) {
+            if (x.size() != good[i])
+                return false;
+        }
+    }
+    std::istringstream is("12 ab");
+    sjtu::deque<Util::Bint> y;
+    try {
+        sjtu::load_text(y, is);
+    } catch (sjtu::runtime_error&) {
+        return y.size() == 1 && y.front() == Util::Bint(12);
+    }
+    return false;
+}
+
+// a bad token on a pipe whose writer is still open throws, and does not
+// wait for input that never comes
+bool openPipeTest() {
+    int fds[2];
+    if (pipe(fds) != 0)
+        return false;
+    const char text[] = "1 2 x 3 4 5 6 7 8 9 ";
+    if (write(fds[1], text, sizeof(text) - 1) != sizeof(text) - 1)
+        return false;
+    sjtu::deque<int> x;
+    bool caught = false;
+    try {
+        sjtu::load_text(x, fds[0], 8);
+    } catch (sjtu::runtime_error&) {
+        caught = true;
+    }
+    close(fds[0]);
+    close(fds[1]);
+    return caught && x.size() == 2;
+}
+
+// append in the flat layout, across the switch to blocks and in blocks
+bool appendTest() {
+    std::deque<Integer> a;
+    sjtu::deque<Integer> x;
+    const size_t sizes[] = {0, 1, 10, 300, FLAT_CAPACITY, 3, N, 1, 20000};
+    for (size_t n : sizes) {
+        std::vector<Integer> v;
+        for (size_t i = 0; i < n; i++)
+            v.push_back(Integer(randnum() % 100000));
+        a.insert(a.end(), v.begin(), v.end());
+        if (randnum() % 2) {
+            const std::vector<Integer>& copied = v;
+            x.append(copied.begin(), copied.end());
+        } else {
+            x.append(v.begin(), v.end());
+        }
+        if (!isEqual(a, x))
+            return false;
+        for (int i = 0; i < 100; i++) {
+            Integer value(i);
+            x.push_front(value), a.push_front(value);
+            x.insert(x.begin() + (x.size() / 2), value);
+            a.insert(a.begin() + (a.size() / 2), value);
+            x.pop_back(), a.pop_back();
+        }
+        if (!isEqual(a, x))
+            return false;
+    }
+    while (!a.empty())
+        a.pop_front(), x.pop_front();
+    return x.empty();
+}
+
+// counts the copies, so a moving append can be told from a copying one
+class tracked {
+   public:
+    static size_t copies;
+    int v;
+    tracked(int v = 0) : v(v) {}
+    tracked(const tracked& other) : v(other.v) { ++copies; }
+    tracked(tracked&& other) noexcept : v(other.v) {}
+    tracked& operator=(const tracked& other) {
+        v = other.v;
+        ++copies;
+        return *this;
+    }
+    tracked& operator=(tracked&& other) noexcept {
+        v = other.v;
+        return *this;
+    }
+};
+size_t tracked::copies = 0;
+
+// append moves out of plain iterators and copies from const ones, both
+// into the ring and into blocks
+bool moveTest() {
+    sjtu::deque<tracked> x;
+    const size_t sizes[] = {10, FLAT_CAPACITY, N};
+    for (size_t n : sizes) {
+        std::vector<tracked> v(n);
+        tracked::copies = 0;
+        x.append(v.begin(), v.end());
+        if (tracked::copies != 0)
+            return false;
+        const std::vector<tracked>& copied = v;
+        x.append(copied.begin(), copied.end());
+        if (tracked::copies != n)
+            return false;
+    }
+    return x.size() == 2 * (10 + FLAT_CAPACITY + N);
+}
+
+int main() {
+    bool (*testFunc[])() = {intTest, doubleTest,    boundaryTest,
+                            bintTest, fdTest,       fileTest,
+                            exceptionTest, openPipeTest, appendTest,
+                            moveTest};
+
+    const char* testMessage[] = {
+        "Testing integers...",
+        "Testing doubles...",
+        "Testing chunk boundaries...",
+        "Testing Bint...",
+        "Testing file descriptors...",
+        "Testing files...",
+        "Testing exceptions...",
+        "Testing an open pipe...",
+        "Testing append...",
+        "Testing moving append...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        fflush(stdout);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
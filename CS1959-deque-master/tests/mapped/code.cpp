@@ -0,0 +1,183 @@
+// mapped_deque: a read-only view over a snapshot file.
+
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "deque.hpp"
+#include "mapped_deque.hpp"
+
+std::default_random_engine randnum(20241123);
+
+// large enough to stay in the block layout
+static const int N = FLAT_CAPACITY + 10000;
+static const char* path = "deque_mapped.bin";
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.cbegin(); it != test.cend(); it++, i++)
+        if (!(*it == ans[i]) || !(test[i] == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+template <typename T>
+bool mapTest(int size, bool middle) {
+    std::deque<T> ans;
+    sjtu::deque<T> deq;
+    for (int i = 0; i < size; i++) {
+        T x = randnum();
+        i % 2 ? (ans.push_back(x), deq.push_back(x))
+              : (ans.push_front(x), deq.push_front(x));
+    }
+    for (int i = 0; middle && i < 3000; i++) {
+        size_t pos = randnum() % ans.size();
+        ans.erase(ans.begin() + pos), deq.erase(deq.begin() + pos);
+    }
+    deq.save(path);
+    sjtu::mapped_deque<T> view(path);
+    sjtu::deque<T> copy = view.to_deque();
+    bool ok = isEqual(ans, view) && isEqual(ans, copy) &&
+              view.end() - view.begin() == (std::ptrdiff_t)ans.size();
+    std::remove(path);
+    return ok;
+}
+
+bool flatTest() { return mapTest<int>(1000, false); }
+
+bool blockTest() { return mapTest<long long>(N, true); }
+
+bool emptyTest() {
+    sjtu::deque<double> deq;
+    deq.save(path);
+    sjtu::mapped_deque<double> view(path);
+    bool ok = view.empty() && view.begin() == view.end();
+    try {
+        view.front();
+        ok = false;
+    } catch (sjtu::container_is_empty&) {
+    }
+    try {
+        view.at(0);
+        ok = false;
+    } catch (sjtu::index_out_of_bound&) {
+    }
+    std::remove(path);
+    return ok;
+}
+
+bool moveTest() {
+    sjtu::deque<int> deq;
+    for (int i = 0; i < 100; i++)
+        deq.push_back(i);
+    deq.save(path);
+    sjtu::mapped_deque<int> view(path);
+    sjtu::mapped_deque<int> other(std::move(view));
+    std::remove(path);
+    // the mapping outlives the file name
+    return view.empty() && other.size() == 100 && other.back() == 99;
+}
+
+// an over-aligned element: the payload must start on a multiple of 16
+// however many entries the block table has
+struct alignas(16) wide {
+    long long lo, hi;
+    wide(long long x = 0) : lo(x), hi(-x) {}
+    bool operator==(const wide& other) const {
+        return lo == other.lo && hi == other.hi;
+    }
+};
+
+bool alignedTest() {
+    for (int n : {1, 100, 200, 300, 400, 1000})
+        if (!mapTest<wide>(n, false))
+            return false;
+    if (!mapTest<wide>(N, true) || !mapTest<wide>(N + 1, true))
+        return false;
+    // and load() skips the padding
+    std::deque<wide> ans;
+    sjtu::deque<wide> deq, other;
+    for (int i = 0; i < 333; i++)
+        ans.push_front(i), deq.push_front(i);
+    deq.save(path);
+    other.load(path);
+    std::remove(path);
+    return isEqual(ans, other);
+}
+
+bool errorTest() {
+    sjtu::deque<int> deq;
+    for (int i = 0; i < 100; i++)
+        deq.push_back(i);
+    deq.save(path);
+    int caught = 0;
+    try {
+        sjtu::mapped_deque<short> wrong(path);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    std::string bytes;
+    {
+        std::ifstream is(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(is), {});
+    }
+    // cut short, and not a snapshot at all
+    std::ofstream(path, std::ios::binary) << bytes.substr(0, bytes.size() - 1);
+    try {
+        sjtu::mapped_deque<int> cut(path);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    std::ofstream(path, std::ios::binary) << "not a deque snapshot at all";
+    try {
+        sjtu::mapped_deque<int> junk(path);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    std::remove(path);
+    try {
+        sjtu::mapped_deque<int> missing(path);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    return caught == 4;
+}
+
+int main() {
+    bool (*testFunc[])() = {flatTest, blockTest,   emptyTest,
+                            moveTest, alignedTest, errorTest};
+
+    const char* testMessage[] = {
+        "Testing flat snapshots...",
+        "Testing block snapshots...",
+        "Testing empty snapshots...",
+        "Testing move...",
+        "Testing over-aligned elements...",
+        "Testing bad snapshots...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+// packed_deque: cold interior blocks are frozen into delta bit-packing.
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <random>
+
+#include "deque.hpp"
+#include "packed_deque.hpp"
+
+std::default_random_engine randnum(20241209);
+
+// 32 elements a block, at most 2 interior blocks plain
+typedef sjtu::packed_deque<int, 32> small_deque;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.cbegin(); it != test.cend(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+template <typename Deque>
+bool withinCap(Deque& deq) {
+    return deq.thawed <= deq.max_thawed + 2 && deq.thawed <= deq.map.blocks;
+}
+
+bool pushPopTest() {
+    std::deque<int> ans;
+    small_deque deq(2);
+    for (int i = 0; i < 200000; i++) {
+        int op = randnum() % 10, x = i * 3 + randnum() % 5;
+        if (op < 3 || ans.empty())
+            ans.push_back(x), deq.push_back(x);
+        else if (op < 6)
+            ans.push_front(-x), deq.push_front(-x);
+        else if (op < 8)
+            ans.pop_back(), deq.pop_back();
+        else
+            ans.pop_front(), deq.pop_front();
+        if (ans.size() != deq.size() || !withinCap(deq) ||
+            (!ans.empty() && (ans.front() != deq.front() ||
+                              ans.back() != deq.back())))
+            return false;
+    }
+    return isEqual(ans, deq) && deq.freezes && deq.thaws;
+}
+
+bool randomAccessTest() {
+    std::deque<int> ans;
+    small_deque deq(2);
+    for (int i = 0; i < 50000; i++)
+        ans.push_back(i), deq.push_back(i);
+    for (int i = 0; i < 20000; i++) {
+        size_t pos = randnum() % ans.size();
+        if (randnum() % 2) {
+            int x = randnum();
+            ans[pos] = x, deq[pos] = x;
+        } else if (deq.at(pos) != ans[pos]) {
+            return false;
+        }
+        if (!withinCap(deq))
+            return false;
+    }
+    if (!isEqual(ans, deq))
+        return false;
+    // drain from both ends through the frozen blocks, pushing back on
+    while (ans.size() > 100) {
+        if (ans.front() != deq.front() || ans.back() != deq.back())
+            return false;
+        ans.pop_front(), deq.pop_front();
+        ans.pop_back(), deq.pop_back();
+        if (ans.size() % 7 == 0)
+            ans.push_back(1), deq.push_back(1);
+    }
+    return isEqual(ans, deq) && deq.frozen_blocks() == 0;
+}
+
+// the extremes of each type, where the differences wrap around
+template <typename T>
+bool extremeTest() {
+    typedef std::numeric_limits<T> lim;
+    const T edges[] = {lim::min(), lim::max(), 0, (T)1, (T)-1,
+                       (T)(lim::max() / 2), (T)(lim::min() + 1)};
+    std::deque<T> ans;
+    sjtu::packed_deque<T, 16> deq(1);
+    for (int i = 0; i < 20000; i++) {
+        T x = randnum() % 3 ? edges[randnum() % 7] : (T)randnum();
+        if (i % 1000 < 500)
+            x = (T)(i / 3);  // runs that pack narrowly
+        ans.push_back(x), deq.push_back(x);
+    }
+    for (int i = 0; i < 2000; i++) {
+        size_t pos = randnum() % ans.size();
+        if (deq.at(pos) != ans[pos])
+            return false;
+    }
+    return isEqual(ans, deq) && deq.frozen_blocks() > 0;
+}
+
+bool typeTest() {
+    return extremeTest<int8_t>() && extremeTest<uint8_t>() &&
+           extremeTest<int16_t>() && extremeTest<int32_t>() &&
+           extremeTest<uint32_t>() && extremeTest<int64_t>() &&
+           extremeTest<uint64_t>() && extremeTest<char>();
+}
+
+// timestamps a few milliseconds apart take under a byte each
+bool ratioTest() {
+    sjtu::packed_deque<int64_t> deq;
+    int64_t t = 1700000000000LL;
+    const size_t n = 1000000;
+    for (size_t i = 0; i < n; i++) {
+        t += randnum() % 50;
+        deq.push_back(t);
+    }
+    size_t plain = n * sizeof(int64_t);
+    long long sum = 0;
+    for (size_t i = 0; i < n; i += 97)
+        sum += deq[i] - 1700000000000LL;
+    return deq.memory_bytes() * 4 < plain && sum > 0 && withinCap(deq);
+}
+
+// a block of equal values packs to no words, and constants are cheap
+bool constantTest() {
+    sjtu::packed_deque<long long, 64> deq(0);
+    for (int i = 0; i < 6400; i++)
+        deq.push_back(42);
+    if (deq.packed_words != 0 || deq.frozen_blocks() != 98)
+        return false;
+    for (int i = 0; i < 6400; i++)
+        if (deq.at(i) != 42)
+            return false;
+    deq[100] = 7;
+    deq.clear();
+    return deq.empty() && deq.thawed == 0 && deq.packed_words == 0;
+}
+
+// a pop into an frozen block makes it an end block, written in place;
+// the writes survive when it is frozen again
+bool endTest() {
+    std::deque<int> ans;
+    small_deque deq(0);
+    size_t n = 10 * small_deque::block_elements;
+    for (size_t i = 0; i < n; i++)
+        ans.push_back(i), deq.push_back(i);
+    // reads only, so that no block is marked written by at()
+    const small_deque& cdeq = deq;
+    for (int round = 0; round < 3; round++) {
+        for (size_t k = 1; k + 1 < deq.map.blocks; k++)
+            cdeq.at(k * small_deque::block_elements);
+        for (size_t i = 0; i < small_deque::block_elements + 7; i++) {
+            ans.pop_back(), deq.pop_back();
+            ans.pop_front(), deq.pop_front();
+        }
+        for (size_t i = 0; i < small_deque::block_elements + 7; i++) {
+            int x = randnum();
+            ans.push_back(x), deq.push_back(x);
+            ans.push_front(x), deq.push_front(x);
+        }
+    }
+    for (size_t k = 1; k + 1 < deq.map.blocks; k++)
+        cdeq.at(k * small_deque::block_elements);
+    return isEqual(ans, deq);
+}
+
+bool exceptionTest() {
+    int caught = 0;
+    small_deque deq;
+    try {
+        deq.pop_front();
+    } catch (sjtu::container_is_empty&) {
+        ++caught;
+    }
+    try {
+        deq.back();
+    } catch (sjtu::container_is_empty&) {
+        ++caught;
+    }
+    deq.push_back(1);
+    try {
+        deq.at(1);
+    } catch (sjtu::index_out_of_bound&) {
+        ++caught;
+    }
+    return caught == 3;
+}
+
+int main() {
+    bool (*testFunc[])() = {pushPopTest,  randomAccessTest, typeTest,
+                            ratioTest,    constantTest,     endTest,
+                            exceptionTest};
+
+    const char* testMessage[] = {
+        "Testing push and pop...",
+        "Testing random access...",
+        "Testing integer types...",
+        "Testing compression ratio...",
+        "Testing constant blocks...",
+        "Testing end blocks...",
+        "Testing exceptions...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+// block size policies: blocks are sized in bytes, not elements, and the
+// flat ring sits on a cache line.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+using Matrix = Diamond::Matrix<double>;
+
+struct alignas(128) wide {
+    int x = 0;
+    wide() = default;
+    wide(int x) : x(x) {}
+};
+
+template <class Policy, class T>
+bool fitsPolicy(size_t bytes) {
+    size_t n = Policy::template block_elements<T>();
+    size_t per = sizeof(typename sjtu::double_list<T>::Node) + sizeof(T);
+    return n >= 1 && (n == 1 || n * per <= bytes) && (n + 1) * per > bytes;
+}
+
+template <class Policy>
+bool policyFor(size_t bytes) {
+    return fitsPolicy<Policy, int>(bytes) &&
+           fitsPolicy<Policy, Matrix>(bytes) &&
+           Policy::template block_elements<int>() >
+               Policy::template block_elements<Matrix>();
+}
+
+bool elementsTest() {
+    using sjtu::l1_block_policy;
+    using sjtu::l2_block_policy;
+    using sjtu::page_block_policy;
+    return policyFor<page_block_policy>(4096) &&
+           policyFor<l1_block_policy>(32 * 1024) &&
+           policyFor<l2_block_policy>(256 * 1024) &&
+           page_block_policy::block_elements<int>() <
+               l1_block_policy::block_elements<int>() &&
+           l1_block_policy::block_elements<int>() <
+               l2_block_policy::block_elements<int>() &&
+           page_block_policy::block_elements<Matrix>() <
+               l1_block_policy::block_elements<Matrix>() &&
+           l1_block_policy::block_elements<Matrix>() <
+               l2_block_policy::block_elements<Matrix>() &&
+           sjtu::count_block_policy::block_elements<int>() ==
+               sjtu::count_block_policy::block_elements<Matrix>();
+}
+
+// past FLAT_CAPACITY the blocks hold at least what the policy asks for,
+// and are split once they reach twice the block size
+template <class Policy>
+bool blocksFor() {
+    sjtu::deque<int, 0, Policy> deq;
+    for (int i = 0; i < FLAT_CAPACITY + 1000; i++)
+        deq.push_back(i);
+    if (deq.flat)
+        return false;
+    size_t block = deq.memory_stats().block_size;
+    if (block != std::max(Policy::template block_elements<int>(),
+                          (size_t)sqrt(deq.last_modified_Size)))
+        return false;
+    for (auto* p = deq.list.head; p != deq.list.end_ptr; p = p->next)
+        if (p->val_ptr->size > 2 * block)
+            return false;
+    return true;
+}
+
+bool blockTest() {
+    return blocksFor<sjtu::page_block_policy>() &&
+           blocksFor<sjtu::l1_block_policy>() &&
+           blocksFor<sjtu::l2_block_policy>();
+}
+
+template <class Deque>
+bool alignedRing(Deque& deq, size_t align) {
+    for (int i = 0; i < 1000; i++) {
+        deq.push_back(i);
+        if (deq.ring != deq.inline_data() &&
+            reinterpret_cast<uintptr_t>(deq.ring) % align)
+            return false;
+        if (i % 3 == 0)
+            deq.pop_front();
+    }
+    deq.shrink_to_fit();
+    return !(reinterpret_cast<uintptr_t>(deq.ring) % align);
+}
+
+bool alignTest() {
+    sjtu::deque<int> ints;
+    sjtu::deque<char, 0, sjtu::l2_block_policy> chars;
+    sjtu::deque<wide> wides;
+    return alignedRing(ints, CACHE_LINE) && alignedRing(chars, CACHE_LINE) &&
+           alignedRing(wides, 128);
+}
+
+int main() {
+    bool (*testFunc[])() = {elementsTest, blockTest, alignTest};
+    const char* testMessage[] = {
+        "Testing block elements...",
+        "Testing block sizes...",
+        "Testing ring alignment...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
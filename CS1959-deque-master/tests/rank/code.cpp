@@ -0,0 +1,165 @@
+// rank and k-th smallest queries, checked against a brute-force scan.
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241019);
+
+static const int MAX_N = 20000;
+
+template <typename Test>
+bool checkQueries(const std::deque<int>& ans, const Test& deq, int rounds) {
+    for (int i = 0; i < rounds; i++) {
+        size_t l = randnum() % (ans.size() + 1);
+        size_t r = randnum() % (ans.size() + 1);
+        if (l > r)
+            std::swap(l, r);
+        int x = randnum() % 1000;
+        size_t expect = 0;
+        for (size_t j = l; j < r; j++)
+            if (ans[j] < x)
+                expect++;
+        if (deq.count_less(l, r, x) != expect)
+            return false;
+        if (l == r)
+            continue;
+        std::vector<int> sorted(ans.begin() + l, ans.begin() + r);
+        std::sort(sorted.begin(), sorted.end());
+        size_t k = randnum() % (r - l);
+        if (deq.kth_smallest(l, r, k) != sorted[k])
+            return false;
+    }
+    return true;
+}
+
+bool scanTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    for (int i = 0; i < MAX_N; i++) {
+        int x = randnum() % 1000;
+        ans.push_back(x);
+        deq.push_back(x);
+    }
+    return checkQueries(ans, deq, 200);
+}
+
+bool indexTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    deq.enable_rank_index();
+    for (int i = 0; i < MAX_N; i++) {
+        int x = randnum() % 1000;
+        ans.push_front(x);
+        deq.push_front(x);
+    }
+    return checkQueries(ans, deq, 500);
+}
+
+bool mutationTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    deq.enable_rank_index();
+    for (int i = 0; i < MAX_N; i++) {
+        int x = randnum() % 1000;
+        ans.push_back(x);
+        deq.push_back(x);
+    }
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 200; i++) {
+            int x = randnum() % 1000;
+            size_t pos = randnum() % ans.size();
+            switch (randnum() % 4) {
+                case 0:
+                    ans.insert(ans.begin() + pos, x);
+                    deq.insert(deq.begin() + pos, x);
+                    break;
+                case 1:
+                    ans.erase(ans.begin() + pos);
+                    deq.erase(deq.begin() + pos);
+                    break;
+                case 2:
+                    ans.pop_front();
+                    deq.pop_front();
+                    ans.push_back(x);
+                    deq.push_back(x);
+                    break;
+                case 3:
+                    // writes in place mark their block, no touch needed
+                    ans[pos] = x;
+                    if (i % 3 == 0)
+                        deq[pos] = x;
+                    else if (i % 3 == 1)
+                        *(deq.begin() + pos) = x;
+                    else
+                        deq.at(pos) = x;
+                    break;
+            }
+        }
+        if (!checkQueries(ans, deq, 20))
+            return false;
+    }
+    // the sorted shadows go away with the index
+    deq.disable_rank_index();
+    for (auto* p = deq.list.head; p != deq.list.end_ptr; p = p->next)
+        if (p->val_ptr->shadow)
+            return false;
+    return true;
+}
+
+bool errorTest() {
+    sjtu::deque<int> deq;
+    deq.enable_rank_index();
+    for (int i = 0; i < 100; i++)
+        deq.push_back(i);
+    int successCounter = 0;
+    try {
+        deq.count_less(50, 101, 0);
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.kth_smallest(10, 20, 10);
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.kth_smallest(20, 10, 0);
+    } catch (...) {
+        successCounter++;
+    }
+    return successCounter == 3 && deq.kth_smallest(10, 20, 9) == 19;
+}
+
+int main() {
+    bool (*testFunc[])() = {scanTest, indexTest, mutationTest, errorTest};
+
+    const char* testMessage[] = {
+        "Testing scan queries...",
+        "Testing indexed queries...",
+        "Testing queries after mutation...",
+        "Testing bad ranges...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
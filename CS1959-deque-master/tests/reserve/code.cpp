@@ -0,0 +1,161 @@
+// reserve, capacity and shrink_to_fit.
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241107);
+
+static size_t allocations = 0;
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, std::align_val_t align) {
+    ++allocations;
+    if (void* ptr = std::aligned_alloc((size_t)align,
+                                       (size + (size_t)align - 1) /
+                                           (size_t)align * (size_t)align))
+        return ptr;
+    throw std::bad_alloc();
+}
+// the deque allocates its ring through the nothrow form
+void* operator new(size_t size, std::align_val_t align,
+                   const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size, align);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+// a reserved ring takes the whole burst without allocating
+bool flatTest() {
+    const size_t n = FLAT_CAPACITY / 2;
+    sjtu::deque<int> deq;
+    deq.reserve(n);
+    if (deq.capacity() < n || deq.front_capacity() < n)
+        return false;
+    size_t before = allocations;
+    for (size_t i = 0; i < n / 2; i++)
+        deq.push_back(i), deq.push_front(-(int)i);
+    if (allocations != before || deq.size() != n)
+        return false;
+    for (size_t i = 0; i < n / 4; i++)
+        deq.pop_back(), deq.pop_front();
+    deq.shrink_to_fit();
+    return deq.capacity() == deq.size() && deq.front() == -(int)(n / 4 - 1) &&
+           deq.back() == (int)(n / 4 - 1);
+}
+
+// past FLAT_CAPACITY only the elements themselves allocate
+bool blockTest() {
+    const size_t n = 4 * FLAT_CAPACITY;
+    sjtu::deque<int> deq;
+    deq.reserve(n);
+    if (deq.capacity() < n)
+        return false;
+    size_t before = allocations;
+    for (size_t i = 0; i < n / 2; i++)
+        deq.push_back(i), deq.push_front(i);
+    if (allocations - before != 2 * n || deq.size() != n)
+        return false;
+    deq.shrink_to_fit();
+    return !deq.spare_count && deq.capacity() == deq.size();
+}
+
+bool shrinkTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    for (int i = 0; i < 2 * FLAT_CAPACITY; i++) {
+        int x = randnum();
+        ans.push_back(x), deq.push_back(x);
+    }
+    for (int i = 0; i < 5000; i++) {
+        size_t pos = randnum() % ans.size();
+        ans.erase(ans.begin() + pos);
+        deq.erase(deq.begin() + pos);
+    }
+    size_t blocks = deq.list.size;
+    deq.shrink_to_fit();
+    if (deq.list.size > blocks)
+        return false;
+    for (auto it = deq.list.begin(); it != deq.list.end(); ++it) {
+        auto next = it;
+        if (++next != deq.list.end() &&
+            it->size + next->size <= deq.get_BlockSize())
+            return false;
+    }
+    return isEqual(ans, deq);
+}
+
+bool inlineTest() {
+    sjtu::deque<Diamond::Matrix<double>, 8> deq;
+    for (int i = 0; i < 100; i++)
+        deq.push_back(Diamond::Matrix<double>(1, 1, i));
+    while (deq.size() > 5)
+        deq.pop_front();
+    deq.shrink_to_fit();
+    if (deq.ring != deq.inline_data() || deq.capacity() != 8)
+        return false;
+    for (int i = 0; i < 5; i++)
+        if (!(deq[i] == Diamond::Matrix<double>(1, 1, 95 + i)))
+            return false;
+    deq.reserve(6);
+    deq.reserve_front(20);
+    return deq.capacity() >= 20 && deq.size() == 5 &&
+           deq.back() == Diamond::Matrix<double>(1, 1, 99);
+}
+
+int main() {
+    bool (*testFunc[])() = {flatTest, blockTest, shrinkTest, inlineTest};
+
+    const char* testMessage[] = {
+        "Testing reserve in flat mode...",
+        "Testing reserve in block mode...",
+        "Testing shrink_to_fit...",
+        "Testing inline slots...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
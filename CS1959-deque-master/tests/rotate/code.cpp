@@ -0,0 +1,289 @@
+// reverse() and rotate(), checked against std::reverse and std::rotate.
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <random>
+
+// small enough that the deques below spend most of their time in blocks
+#define FLAT_CAPACITY 1024
+
+#include "class-bint.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241019);
+
+static const int MAX_N = 20000;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); ++it, ++i)
+        if (!(*it == ans[i]))
+            return false;
+    if (i != ans.size())
+        return false;
+    for (int k = 0; k < 100 && !ans.empty(); k++) {
+        size_t pos = randnum() % ans.size();
+        if (!(test[pos] == ans[pos]))
+            return false;
+    }
+    return ans.empty() || (test.front() == ans.front() && test.back() == ans.back());
+}
+
+template <typename Ans, typename Test>
+void randnumFill(Ans& ans, Test& test, int n) {
+    for (int i = 0; i < n; i++) {
+        int x = randnum();
+        if (randnum() % 2) {
+            ans.push_back(x);
+            test.push_back(x);
+        } else {
+            ans.push_front(x);
+            test.push_front(x);
+        }
+    }
+}
+
+bool reverseTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    deq.reverse();
+    randnumFill(ans, deq, MAX_N);
+    for (int i = 0; i < 5; i++) {
+        std::reverse(ans.begin(), ans.end());
+        deq.reverse();
+        if (!isEqual(ans, deq))
+            return false;
+        randnumFill(ans, deq, 1000);
+    }
+    return true;
+}
+
+bool rotateTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    deq.rotate(3);
+    randnumFill(ans, deq, MAX_N);
+    for (int i = 0; i < 2000; i++) {
+        size_t k = randnum() % (2 * ans.size());
+        std::rotate(ans.begin(), ans.begin() + k % ans.size(), ans.end());
+        deq.rotate(k);
+        if (i % 200 == 0 && !isEqual(ans, deq))
+            return false;
+    }
+    return isEqual(ans, deq);
+}
+
+bool roundRobinTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    randnumFill(ans, deq, MAX_N);
+    // rotating by one again and again must not shred the blocks
+    for (int i = 0; i < MAX_N; i++) {
+        ans.push_back(ans.front());
+        ans.pop_front();
+        deq.rotate(1);
+    }
+    return isEqual(ans, deq) && deq.list.size < MAX_N / 64;
+}
+
+template <typename Ans, typename Test>
+bool isEqualBackwards(Ans& ans, Test& test) {
+    size_t i = ans.size();
+    for (auto it = test.end(); it != test.begin();) {
+        --it;
+        if (i == 0 || !(*it == ans[--i]))
+            return false;
+    }
+    return i == 0;
+}
+
+bool flagTest() {
+    sjtu::deque<int> deq;
+    for (int i = 0; i < MAX_N; i++)
+        deq.push_back(i);
+    // reverse() flips a flag, the blocks stay where they are
+    auto head = deq.list.head;
+    for (int i = 0; i < 1000001; i++)
+        deq.reverse();
+    return deq.list.head == head && deq.front() == MAX_N - 1 &&
+           deq.back() == 0 && deq[1] == MAX_N - 2 && *deq.cbegin() == MAX_N - 1;
+}
+
+bool reversedOps(int n) {
+    std::deque<int> ans, ans2;
+    sjtu::deque<int> deq, deq2;
+    randnumFill(ans, deq, n);
+    for (int i = 0; i < 20000; i++) {
+        int x = randnum();
+        switch (randnum() % 12) {
+            case 0:
+                ans.push_back(x);
+                deq.push_back(x);
+                break;
+            case 1:
+                ans.push_front(x);
+                deq.push_front(x);
+                break;
+            case 2:
+                if (!ans.empty()) {
+                    ans.pop_back();
+                    deq.pop_back();
+                }
+                break;
+            case 3:
+                if (!ans.empty()) {
+                    ans.pop_front();
+                    deq.pop_front();
+                }
+                break;
+            case 4: {
+                size_t pos = randnum() % (ans.size() + 1);
+                ans.insert(ans.begin() + pos, x);
+                auto it = deq.insert(deq.begin() + pos, x);
+                if (it - deq.begin() != (long)pos || *it != x)
+                    return false;
+                break;
+            }
+            case 5: {
+                if (ans.empty())
+                    break;
+                size_t pos = randnum() % ans.size();
+                ans.erase(ans.begin() + pos);
+                auto it = deq.erase(deq.begin() + pos);
+                if (it - deq.begin() != (long)pos ||
+                    (pos < ans.size() && *it != ans[pos]))
+                    return false;
+                break;
+            }
+            case 6:
+            case 7:
+                std::reverse(ans.begin(), ans.end());
+                deq.reverse();
+                break;
+            case 8: {
+                if (ans.empty())
+                    break;
+                size_t k = randnum() % ans.size();
+                std::rotate(ans.begin(), ans.begin() + k, ans.end());
+                deq.rotate(k);
+                break;
+            }
+            case 9: {
+                size_t n = randnum() % (ans.size() + 1);
+                if (randnum() % 2) {
+                    ans2.insert(ans2.end(), ans.begin(), ans.begin() + n);
+                    ans.erase(ans.begin(), ans.begin() + n);
+                    deq.transfer_front(deq2, n);
+                } else {
+                    ans2.insert(ans2.begin(), ans.end() - n, ans.end());
+                    ans.erase(ans.end() - n, ans.end());
+                    deq.transfer_back(deq2, n);
+                }
+                if (randnum() % 2) {
+                    std::reverse(ans2.begin(), ans2.end());
+                    deq2.reverse();
+                }
+                ans.swap(ans2);
+                deq.swap(deq2);
+                break;
+            }
+            case 10: {
+                if (ans.empty())
+                    break;
+                size_t l = randnum() % ans.size(), r = l + randnum() % (ans.size() - l);
+                size_t cnt = std::count_if(ans.begin() + l, ans.begin() + r,
+                                           [x](int v) { return v < x; });
+                if (deq.count_less(l, r, x) != cnt)
+                    return false;
+                break;
+            }
+            case 11: {
+                std::vector<int> add(randnum() % 20, x);
+                ans.insert(ans.end(), add.begin(), add.end());
+                deq.append(add.begin(), add.end());
+                break;
+            }
+        }
+        if (i % 500 == 0 && (!isEqual(ans, deq) || !isEqualBackwards(ans, deq)))
+            return false;
+    }
+    std::vector<int> out = deq.into_vector();
+    return std::equal(ans.begin(), ans.end(), out.begin(), out.end()) &&
+           deq.empty() && isEqual(ans2, deq2);
+}
+
+// from a ring and from blocks
+bool reversedTest() { return reversedOps(50) && reversedOps(3000); }
+
+bool mixedTest() {
+    std::deque<Util::Bint> ans;
+    sjtu::deque<Util::Bint> deq;
+    for (int i = 0; i < 2000; i++) {
+        Util::Bint x = Util::Bint((long long)randnum()) * (long long)randnum();
+        switch (randnum() % 5) {
+            case 0:
+                ans.push_back(x);
+                deq.push_back(x);
+                break;
+            case 1:
+                ans.push_front(x);
+                deq.push_front(x);
+                break;
+            case 2: {
+                size_t pos = randnum() % (ans.size() + 1);
+                ans.insert(ans.begin() + pos, x);
+                deq.insert(deq.begin() + pos, x);
+                break;
+            }
+            case 3: {
+                if (ans.empty())
+                    break;
+                size_t k = randnum() % (ans.size() + 1);
+                std::rotate(ans.begin(), ans.begin() + k % ans.size(), ans.end());
+                deq.rotate(k);
+                break;
+            }
+            case 4:
+                std::reverse(ans.begin(), ans.end());
+                deq.reverse();
+                break;
+        }
+    }
+    return isEqual(ans, deq);
+}
+
+int main() {
+    bool (*testFunc[])() = {reverseTest, rotateTest,   roundRobinTest,
+                            flagTest,    reversedTest, mixedTest};
+
+    const char* testMessage[] = {
+        "Testing reverse...",
+        "Testing rotate...",
+        "Testing round robin...",
+        "Testing reverse by flag...",
+        "Testing operations on reversed deques...",
+        "Testing mixed operations...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+// shm_deque: a deque in shared memory, used from several processes.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+
+#include "deque.hpp"
+#include "shm_deque.hpp"
+
+std::default_random_engine randnum(20241213);
+
+static const char* name = "/sjtu_deque_test";
+
+// 62 ints a block
+typedef sjtu::shm_deque<int, 256> small_deque;
+
+bool sameAs(std::deque<int>& ans, small_deque& deq) {
+    if (ans.size() != deq.size())
+        return false;
+    for (size_t i = 0; i < ans.size(); i += 7)
+        if (deq.at(i) != ans[i])
+            return false;
+    return ans.empty() ||
+           (ans.front() == deq.front() && ans.back() == deq.back());
+}
+
+bool endsTest() {
+    std::deque<int> ans;
+    small_deque deq(name, 5000);
+    for (int i = 0; i < 100000; i++) {
+        int op = randnum() % 4, x = randnum();
+        if (ans.size() < 5000 && (op == 0 || ans.empty()))
+            ans.push_back(x), deq.push_back(x);
+        else if (ans.size() < 5000 && op == 1)
+            ans.push_front(x), deq.push_front(x);
+        else if (op == 2)
+            ans.pop_back(), deq.pop_back();
+        else
+            ans.pop_front(), deq.pop_front();
+        if (i % 1000 == 0 && !sameAs(ans, deq))
+            return false;
+    }
+    bool ok = sameAs(ans, deq);
+    small_deque::remove(name);
+    return ok;
+}
+
+bool fullTest() {
+    small_deque deq(name, 100);
+    for (int i = 0; i < 100; i++)
+        i % 2 ? deq.push_back(i) : deq.push_front(i);
+    int caught = 0, out;
+    try {
+        deq.push_back(0);
+    } catch (sjtu::container_is_full&) {
+        ++caught;
+    }
+    bool ok = !deq.try_push_front(0) && deq.size() == 100;
+    while (deq.try_pop_back(out))
+        ;
+    try {
+        deq.pop_front();
+    } catch (sjtu::container_is_empty&) {
+        ++caught;
+    }
+    small_deque::remove(name);
+    return ok && caught == 2 && deq.empty();
+}
+
+// producers and consumers in separate processes
+bool processTest() {
+    const int producers = 3, items = 20000;
+    small_deque deq(name, 256);
+    sjtu::shm_deque<long long> result("/sjtu_deque_result", 1);
+    for (int p = 0; p < producers; p++) {
+        if (!fork()) {
+            small_deque child(name);
+            for (int i = 1; i <= items; i++)
+                child.wait_push_back(p * items + i);
+            _exit(0);
+        }
+    }
+    pid_t consumer = fork();
+    if (!consumer) {
+        // takes half from the back, which must still be in order per producer
+        small_deque child(name);
+        sjtu::shm_deque<long long> child_result("/sjtu_deque_result");
+        long long sum = 0;
+        for (int i = 0; i < producers * items / 2; i++)
+            sum += child.wait_pop_back();
+        child_result.push_back(sum);
+        _exit(0);
+    }
+    long long sum = 0;
+    int last[producers] = {0, 0, 0};
+    bool ordered = true;
+    for (int i = 0; i < producers * items / 2; i++) {
+        int x = deq.wait_pop_front();
+        int p = (x - 1) / items;
+        ordered &= x > last[p];
+        last[p] = x;
+        sum += x;
+    }
+    for (int p = 0; p < producers + 1; p++)
+        wait(nullptr);
+    long long n = producers * items;
+    bool ok = ordered && deq.empty() &&
+              sum + result.wait_pop_front() == n * (n + 1) / 2;
+    small_deque::remove(name);
+    result.remove("/sjtu_deque_result");
+    return ok;
+}
+
+bool openTest() {
+    int caught = 0;
+    try {
+        small_deque deq("/sjtu_deque_missing");
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    small_deque deq(name, 10);
+    try {
+        sjtu::shm_deque<long long, 256> wrong(name);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    small_deque other(name);
+    other.push_back(42);
+    small_deque::remove(name);
+    return caught == 2 && deq.front() == 42;
+}
+
+// a process killed holding the lock poisons the deque until reset()
+bool deadOwnerTest() {
+    small_deque deq(name, 100);
+    for (int i = 0; i < 10; i++)
+        deq.push_back(i);
+    pid_t pid = fork();
+    if (!pid) {
+        small_deque child(name);
+        small_deque::guard lock(child.hdr);
+        raise(SIGKILL);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    int caught = 0;
+    try {
+        deq.push_back(10);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    try {
+        deq.size();
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    deq.reset();
+    deq.push_back(1);
+    bool ok = WIFSIGNALED(status) && caught == 2 && deq.size() == 1 &&
+              deq.front() == 1;
+    small_deque::remove(name);
+    return ok;
+}
+
+int main() {
+    bool (*testFunc[])() = {endsTest, fullTest, processTest, openTest,
+                            deadOwnerTest};
+
+    const char* testMessage[] = {
+        "Testing push and pop...",
+        "Testing a full deque...",
+        "Testing several processes...",
+        "Testing opening...",
+        "Testing a dead lock owner...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        fflush(stdout);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
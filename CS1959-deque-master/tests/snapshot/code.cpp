@@ -0,0 +1,226 @@
+// save and load: binary snapshots of a deque.
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "class-bint.hpp"
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241117);
+
+// large enough to stay in the block layout
+static const int N = FLAT_CAPACITY + 10000;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+template <typename T>
+bool roundTrip(std::deque<T>& ans, sjtu::deque<T>& deq) {
+    std::stringstream ss;
+    deq.save(ss);
+    sjtu::deque<T> other;
+    other.push_back(ans.front());
+    other.load(ss);
+    return isEqual(ans, deq) && isEqual(ans, other);
+}
+
+bool flatTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    for (int i = 0; i < 1000; i++) {
+        int x = randnum();
+        ans.push_front(x), deq.push_front(x);
+        if (i % 3 == 0)
+            ans.pop_back(), deq.pop_back();
+    }
+    std::stringstream ss;
+    sjtu::deque<int> empty, other;
+    empty.save(ss);
+    other.load(ss);
+    return other.empty() && roundTrip(ans, deq);
+}
+
+bool blockTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    for (int i = 0; i < N; i++) {
+        int x = randnum();
+        ans.push_back(x), deq.push_back(x);
+    }
+    for (int i = 0; i < 5000; i++) {
+        size_t pos = randnum() % ans.size();
+        ans.insert(ans.begin() + pos, i), deq.insert(deq.begin() + pos, i);
+    }
+    std::stringstream ss;
+    deq.save(ss);
+    sjtu::deque<int> other;
+    other.load(ss);
+    // the loaded blocks are balanced, whatever the saved ones were
+    size_t lo = N, hi = 0;
+    for (auto p = other.list.head; p != other.list.end_ptr; p = p->next) {
+        lo = std::min(lo, p->val_ptr->size);
+        hi = std::max(hi, p->val_ptr->size);
+    }
+    return !other.flat && hi - lo <= 1 &&
+           hi <= other.block_size_for(ans.size()) && isEqual(ans, other) &&
+           isEqual(ans, deq);
+}
+
+bool bintTest() {
+    std::deque<Util::Bint> ans;
+    sjtu::deque<Util::Bint> deq;
+    for (int i = 0; i < 3000; i++) {
+        Util::Bint x = Util::Bint((int)randnum() % 100000 - 50000) *
+                       Util::Bint((long long)randnum() * (long long)randnum());
+        ans.push_back(x), deq.push_back(x);
+    }
+    ans.push_front(0), deq.push_front(0);
+    return roundTrip(ans, deq);
+}
+
+bool matrixTest() {
+    std::deque<Diamond::Matrix<double>> ans;
+    sjtu::deque<Diamond::Matrix<double>> deq;
+    for (int i = 0; i < N; i++) {
+        Diamond::Matrix<double> m(1 + i % 3, 2, i * 0.5);
+        ans.push_back(m), deq.push_back(m);
+    }
+    return roundTrip(ans, deq);
+}
+
+bool fileTest() {
+    std::deque<long long> ans;
+    sjtu::deque<long long> deq, other;
+    for (int i = 0; i < N; i++) {
+        long long x = (long long)randnum() << 20;
+        ans.push_front(x), deq.push_front(x);
+    }
+    const char* path = "deque_snapshot.bin";
+    deq.save(path);
+    other.load(path);
+    std::remove(path);
+    return isEqual(ans, other);
+}
+
+// a reversed deque is saved in the order it reads
+bool reversedTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    std::deque<Util::Bint> bans;
+    sjtu::deque<Util::Bint> bdeq;
+    for (int i = 0; i < N; i++) {
+        int x = randnum();
+        ans.push_back(x), deq.push_back(x);
+        if (i % 50 == 0)
+            bans.push_back(x), bdeq.push_back(x);
+        if (i == 1000 || i == N - 1) {
+            std::reverse(ans.begin(), ans.end()), deq.reverse();
+            std::reverse(bans.begin(), bans.end()), bdeq.reverse();
+            if (!roundTrip(ans, deq) || !roundTrip(bans, bdeq))
+                return false;
+        }
+    }
+    return !deq.flat;
+}
+
+// loading replaces the elements, not the rank index or the spare blocks
+bool settingsTest() {
+    sjtu::deque<int> deq, other;
+    for (int i = 0; i < N; i++)
+        deq.push_back(N - i);
+    std::stringstream ss;
+    deq.save(ss);
+    other.enable_rank_index();
+    other.reserve(3 * N);
+    size_t spares = other.spare_count, limit = other.spare_limit;
+    other.load(ss);
+    return other.rank_index && spares && other.spare_count == spares &&
+           other.spare_limit == limit && other.count_less(0, N, 100) == 99 &&
+           isEqual(deq, other);
+}
+
+bool errorTest() {
+    sjtu::deque<int> deq, other;
+    for (int i = 0; i < 100; i++)
+        deq.push_back(i), other.push_back(-i);
+    std::stringstream ss;
+    deq.save(ss);
+    std::string bytes = ss.str();
+    int caught = 0;
+    // cut short, another element type, and not a snapshot at all
+    try {
+        std::stringstream cut(bytes.substr(0, bytes.size() - 1));
+        other.load(cut);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    try {
+        sjtu::deque<short> wrong;
+        std::stringstream in(bytes);
+        wrong.load(in);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    try {
+        std::stringstream junk("not a deque snapshot at all");
+        other.load(junk);
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    try {
+        other.load("no/such/dir/snapshot.bin");
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    return caught == 4 && other.size() == 100 && other.back() == -99;
+}
+
+int main() {
+    bool (*testFunc[])() = {flatTest,     blockTest,    bintTest,
+                            matrixTest,   fileTest,     reversedTest,
+                            settingsTest, errorTest};
+
+    const char* testMessage[] = {
+        "Testing flat snapshots...",
+        "Testing block snapshots...",
+        "Testing Bint snapshots...",
+        "Testing Matrix snapshots...",
+        "Testing snapshot files...",
+        "Testing reversed snapshots...",
+        "Testing settings kept by load...",
+        "Testing bad snapshots...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
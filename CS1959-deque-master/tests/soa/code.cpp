@@ -0,0 +1,238 @@
+// soa_deque: records stored one array a field in each block.
+
+#define SOA_BLOCK_ELEMENTS 16
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+
+#include "deque.hpp"
+#include "soa_deque.hpp"
+
+std::default_random_engine randnum(20241221);
+
+typedef std::tuple<long long, double, int> record;
+typedef sjtu::soa_deque<long long, double, int> records;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.cbegin(); it != test.cend(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+// blocks are neither empty nor over full, and hold all the elements
+template <typename Deque>
+bool isSound(Deque& deq) {
+    size_t sum = 0;
+    for (size_t k = 0; k < deq.map.blocks; k++) {
+        auto* blk = deq.map.block_at(k);
+        if (!blk->size || blk->head + blk->size > deq.block_elements)
+            return false;
+        sum += blk->size;
+    }
+    return sum == deq.size();
+}
+
+record makeRecord(int i) { return record(i * 1000LL, i * 0.25, -i); }
+
+bool pushPopTest() {
+    std::deque<record> ans;
+    records deq;
+    for (int i = 0; i < 100000; i++) {
+        int op = randnum() % 10;
+        if (op < 3 || ans.empty()) {
+            ans.push_back(makeRecord(i));
+            deq.push_back(i * 1000LL, i * 0.25, -i);
+        } else if (op < 6) {
+            ans.push_front(makeRecord(i)), deq.push_front(makeRecord(i));
+        } else if (op < 8) {
+            ans.pop_back(), deq.pop_back();
+        } else {
+            ans.pop_front(), deq.pop_front();
+        }
+        if (ans.size() != deq.size() ||
+            (!ans.empty() && (ans.front() != deq.front() ||
+                              ans.back() != deq.back())))
+            return false;
+    }
+    return isEqual(ans, deq) && isSound(deq);
+}
+
+bool insertEraseTest() {
+    std::deque<record> ans;
+    records deq;
+    for (int i = 0; i < 30000; i++) {
+        int op = randnum() % 10;
+        size_t pos = randnum() % (ans.size() + 1);
+        if (op < 6 || ans.empty()) {
+            ans.insert(ans.begin() + pos, makeRecord(i));
+            auto it = deq.insert(pos, makeRecord(i));
+            if (*it != makeRecord(i))
+                return false;
+        } else {
+            pos %= ans.size();
+            ans.erase(ans.begin() + pos);
+            auto it = deq.erase(deq.cbegin() + pos);
+            if (pos < ans.size() && *it != ans[pos])
+                return false;
+        }
+        if (i % 1000 == 0 && (!isEqual(ans, deq) || !isSound(deq)))
+            return false;
+    }
+    // erase down to a few, merging the blocks on the way
+    while (ans.size() > 10) {
+        size_t pos = randnum() % ans.size();
+        ans.erase(ans.begin() + pos), deq.erase(pos);
+    }
+    return isEqual(ans, deq) && isSound(deq) && deq.map.blocks <= 2;
+}
+
+// tuples of references read and write through
+bool proxyTest() {
+    records deq;
+    for (int i = 0; i < 1000; i++)
+        deq.push_back(makeRecord(i));
+    deq[10] = makeRecord(-5);
+    std::get<1>(deq.at(20)) = 7.5;
+    deq.get<2>(30) += 100;
+    for (auto it = deq.begin(); it != deq.end(); ++it)
+        std::get<0>(*it) += 1;
+    const records& c = deq;
+    record r = c[20];
+    long long a;
+    double b;
+    int d;
+    std::tie(a, b, d) = c.at(30);
+    return c[10] == record(-4999, -1.25, 5) && r == record(20001, 7.5, -20) &&
+           a == 30001 && d == 70 && c.get<0>(999) == 999001;
+}
+
+// the runs of one column add up to the whole column
+bool segmentTest() {
+    records deq;
+    long long expect = 0;
+    for (int i = 0; i < 5000; i++) {
+        deq.push_front(makeRecord(i)), expect += i * 1000LL;
+        if (i % 3 == 0)
+            deq.insert(deq.size() / 2, makeRecord(i)), expect += i * 1000LL;
+    }
+    long long sum = 0;
+    size_t count = 0, runs = 0;
+    deq.for_each_segment<0>([&](const long long* data, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            sum += data[i];
+        count += n, ++runs;
+    });
+    deq.for_each_segment<2>([](int* data, size_t n) {
+        for (size_t i = 0; i < n; i++)
+            data[i] = 1;
+    });
+    int ones = 0;
+    for (size_t i = 0; i < deq.size(); i++)
+        ones += deq.get<2>(i);
+    return sum == expect && count == deq.size() && runs == deq.map.blocks &&
+           ones == (int)deq.size() &&
+           (uintptr_t)&deq.get<1>(0) % CACHE_LINE ==
+               (deq.map.block_at(0)->head * sizeof(double)) % CACHE_LINE;
+}
+
+// fields that own memory
+bool classTest() {
+    typedef std::tuple<std::string, int> named;
+    std::deque<named> ans;
+    sjtu::soa_deque<std::string, int> deq;
+    for (int i = 0; i < 20000; i++) {
+        named v(std::string(randnum() % 40, 'a' + i % 26), i);
+        size_t pos = randnum() % (ans.size() + 1);
+        int op = randnum() % 6;
+        if (op < 2) {
+            ans.insert(ans.begin() + pos, v), deq.insert(pos, v);
+        } else if (op < 4) {
+            ans.push_back(v), deq.push_back(v);
+        } else if (!ans.empty()) {
+            pos %= ans.size();
+            ans.erase(ans.begin() + pos), deq.erase(pos);
+        }
+    }
+    sjtu::soa_deque<std::string, int> copy(deq), moved;
+    moved = std::move(deq);
+    copy.push_back("x", 1);
+    ans.push_back(named("x", 1));
+    moved = copy;
+    return isEqual(ans, copy) && isEqual(ans, moved) && deq.empty();
+}
+
+bool exceptionTest() {
+    int caught = 0;
+    records deq;
+    try {
+        deq.pop_back();
+    } catch (sjtu::container_is_empty&) {
+        ++caught;
+    }
+    deq.push_back(makeRecord(1));
+    try {
+        deq.insert(2, makeRecord(2));
+    } catch (sjtu::index_out_of_bound&) {
+        ++caught;
+    }
+    try {
+        deq.erase(1);
+    } catch (sjtu::index_out_of_bound&) {
+        ++caught;
+    }
+    records other;
+    try {
+        deq.erase(other.cbegin());
+    } catch (sjtu::invalid_iterator&) {
+        ++caught;
+    }
+    try {
+        *deq.end();
+    } catch (sjtu::invalid_iterator&) {
+        ++caught;
+    }
+    return caught == 5 && deq.size() == 1;
+}
+
+int main() {
+    bool (*testFunc[])() = {pushPopTest,  insertEraseTest, proxyTest,
+                            segmentTest, classTest,       exceptionTest};
+
+    const char* testMessage[] = {
+        "Testing push and pop...",
+        "Testing insert and erase...",
+        "Testing references...",
+        "Testing column segments...",
+        "Testing class fields...",
+        "Testing exceptions...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+// spare blocks: emptied blocks are reused instead of freed and reallocated.
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241103);
+
+static size_t allocations = 0;
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+// large enough to stay in the block layout
+static const int N = FLAT_CAPACITY + 10000;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+// each push allocates the element and its node, never a block
+template <bool Front>
+bool thrashTest() {
+    sjtu::deque<int> deq;
+    for (int i = 0; i < N; i++)
+        deq.push_back(i);
+    size_t blocks = deq.list.size;
+    size_t span = 4 * deq.get_BlockSize(), pushes = 0;
+    size_t before = allocations;
+    for (int round = 0; round < 200; round++) {
+        for (size_t i = 0; i < span; i++, pushes++)
+            Front ? deq.push_front(-1) : deq.push_back(-1);
+        for (size_t i = 0; i < span; i++)
+            Front ? deq.pop_front() : deq.pop_back();
+    }
+    return allocations - before <= 2 * pushes + SPARE_BLOCKS * 2 &&
+           deq.size() == N && deq.list.size <= blocks + 1 &&
+           deq.front() == 0 && deq.back() == N - 1;
+}
+
+bool middleTest() {
+    std::deque<int> ans;
+    sjtu::deque<int> deq;
+    for (int i = 0; i < N; i++) {
+        int x = randnum();
+        ans.push_back(x), deq.push_back(x);
+    }
+    for (int i = 0; i < 20000; i++) {
+        size_t pos = randnum() % (ans.size() + 1);
+        if (randnum() % 2) {
+            int x = randnum();
+            ans.insert(ans.begin() + pos, x);
+            deq.insert(deq.begin() + pos, x);
+        } else if (pos < ans.size()) {
+            ans.erase(ans.begin() + pos);
+            deq.erase(deq.begin() + pos);
+        }
+        if (deq.spare_count > SPARE_BLOCKS)
+            return false;
+    }
+    return isEqual(ans, deq);
+}
+
+bool classTest() {
+    std::deque<Diamond::Matrix<double>> ans;
+    sjtu::deque<Diamond::Matrix<double>> deq;
+    for (int i = 0; i < N; i++) {
+        Diamond::Matrix<double> m(1, 2, i * 0.5);
+        ans.push_back(m), deq.push_back(m);
+    }
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 3000; i++) {
+            Diamond::Matrix<double> m(2, 1, round + i);
+            ans.push_front(m), deq.push_front(m);
+        }
+        for (int i = 0; i < 2000; i++)
+            ans.pop_front(), deq.pop_front(), ans.pop_back(), deq.pop_back();
+    }
+    sjtu::deque<Diamond::Matrix<double>> other(deq);
+    return isEqual(ans, deq) && isEqual(ans, other) && !other.spare_count;
+}
+
+int main() {
+    bool (*testFunc[])() = {thrashTest<true>, thrashTest<false>, middleTest,
+                            classTest};
+
+    const char* testMessage[] = {
+        "Testing push_front and pop_front...",
+        "Testing push_back and pop_back...",
+        "Testing insert and erase...",
+        "Testing class elements...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
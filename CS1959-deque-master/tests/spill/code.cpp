@@ -0,0 +1,210 @@
+// spill_deque: interior blocks are evicted to a spill file past the cap.
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+
+#include "deque.hpp"
+#include "spill_deque.hpp"
+
+std::default_random_engine randnum(20241201);
+
+static const char* path = "deque_spill.bin";
+
+// 32 ints a block, at most 4 blocks in memory
+typedef sjtu::spill_deque<int, 128> small_deque;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.cbegin(); it != test.cend(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+bool withinCap(small_deque& deq) {
+    return deq.resident <= deq.max_resident && deq.resident <= deq.map.blocks;
+}
+
+bool pushPopTest() {
+    std::deque<int> ans;
+    small_deque deq(path, 4 * small_deque::block_bytes);
+    for (int i = 0; i < 200000; i++) {
+        int op = randnum() % 10, x = randnum();
+        if (op < 3 || ans.empty())
+            ans.push_back(x), deq.push_back(x);
+        else if (op < 6)
+            ans.push_front(x), deq.push_front(x);
+        else if (op < 8)
+            ans.pop_back(), deq.pop_back();
+        else
+            ans.pop_front(), deq.pop_front();
+        if (ans.size() != deq.size() || !withinCap(deq) ||
+            (!ans.empty() && (ans.front() != deq.front() ||
+                              ans.back() != deq.back())))
+            return false;
+    }
+    return isEqual(ans, deq) && deq.evictions && deq.faults;
+}
+
+bool randomAccessTest() {
+    std::deque<int> ans;
+    small_deque deq(path, 4 * small_deque::block_bytes);
+    for (int i = 0; i < 50000; i++)
+        ans.push_back(i), deq.push_back(i);
+    for (int i = 0; i < 20000; i++) {
+        size_t pos = randnum() % ans.size();
+        if (randnum() % 2) {
+            int x = randnum();
+            ans[pos] = x, deq[pos] = x;
+        } else if (deq.at(pos) != ans[pos]) {
+            return false;
+        }
+        if (!withinCap(deq))
+            return false;
+    }
+    // drain from both ends through the evicted blocks
+    while (ans.size() > 100) {
+        if (ans.front() != deq.front() || ans.back() != deq.back())
+            return false;
+        ans.pop_front(), deq.pop_front();
+        ans.pop_back(), deq.pop_back();
+    }
+    return isEqual(ans, deq) && deq.spilled_blocks() == 0;
+}
+
+bool capTest() {
+    sjtu::spill_deque<long long> deq(path, 1 << 20);
+    for (long long i = 0; i < 2000000; i++)
+        deq.push_back(i * 3);
+    long long sum = 0;
+    for (auto it = deq.cbegin(); it != deq.cend(); ++it)
+        sum += *it;
+    // 16M of elements in 1M of memory, and a scan faults each block once
+    return sum == 3LL * 1999999 * 2000000 / 2 &&
+           deq.resident * deq.block_bytes <= (1 << 20) &&
+           deq.faults <= deq.map.blocks;
+}
+
+bool clearTest() {
+    small_deque deq(path, 0);
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 5000; i++)
+            deq.push_front(i);
+        if (deq.at(2500) != 2499 || deq.max_resident != 3)
+            return false;
+        round % 2 ? deq.clear() : (void)0;
+        while (!deq.empty())
+            deq.pop_back();
+    }
+    return deq.resident == 0 && deq.map.blocks == 0;
+}
+
+// a pop into an evicted block makes it an end block, written in place;
+// the writes survive when it is evicted again
+bool endTest() {
+    std::deque<int> ans;
+    small_deque deq(path, 0);
+    size_t n = 10 * small_deque::block_elements;
+    for (size_t i = 0; i < n; i++)
+        ans.push_back(i), deq.push_back(i);
+    // reads only, so that no block is marked written by at()
+    const small_deque& cdeq = deq;
+    for (int round = 0; round < 3; round++) {
+        for (size_t k = 1; k + 1 < deq.map.blocks; k++)
+            cdeq.at(k * small_deque::block_elements);
+        for (size_t i = 0; i < small_deque::block_elements + 7; i++) {
+            ans.pop_back(), deq.pop_back();
+            ans.pop_front(), deq.pop_front();
+        }
+        for (size_t i = 0; i < small_deque::block_elements + 7; i++) {
+            int x = randnum();
+            ans.push_back(x), deq.push_back(x);
+            ans.push_front(x), deq.push_front(x);
+        }
+    }
+    for (size_t k = 1; k + 1 < deq.map.blocks; k++)
+        cdeq.at(k * small_deque::block_elements);
+    return isEqual(ans, deq);
+}
+
+bool exceptionTest() {
+    int caught = 0;
+    try {
+        small_deque deq("no/such/dir/spill.bin");
+    } catch (sjtu::runtime_error&) {
+        ++caught;
+    }
+    small_deque deq(path);
+    try {
+        deq.pop_front();
+    } catch (sjtu::container_is_empty&) {
+        ++caught;
+    }
+    deq.push_back(1);
+    try {
+        deq.at(1);
+    } catch (sjtu::index_out_of_bound&) {
+        ++caught;
+    }
+    return caught == 3;
+}
+
+// over-aligned elements keep their alignment through eviction and faults
+struct alignas(64) line {
+    int x;
+};
+
+bool alignTest() {
+    sjtu::spill_deque<line, 256> deq(path, 0);
+    for (int i = 0; i < 2000; i++)
+        i % 2 ? deq.push_back({i}) : deq.push_front({i});
+    for (int i = 0; i < 2000; i++) {
+        const line& val = deq[randnum() % deq.size()];
+        if (reinterpret_cast<uintptr_t>(&val) % alignof(line))
+            return false;
+    }
+    for (size_t i = 0; i < deq.size(); i++)
+        if (deq[i].x != (i < 1000 ? 1998 - 2 * (int)i : 2 * (int)i - 1999))
+            return false;
+    return deq.evictions && deq.faults;
+}
+
+int main() {
+    bool (*testFunc[])() = {pushPopTest, randomAccessTest, capTest,
+                            clearTest, endTest, exceptionTest, alignTest};
+
+    const char* testMessage[] = {
+        "Testing push and pop...",
+        "Testing random access...",
+        "Testing the memory cap...",
+        "Testing clear...",
+        "Testing end blocks...",
+        "Testing exceptions...",
+        "Testing alignment...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
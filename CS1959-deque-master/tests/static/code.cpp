@@ -0,0 +1,211 @@
+// static_deque: fixed capacity, inline ring buffer, no heap allocation.
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "static_deque.hpp"
+
+std::default_random_engine randnum(20241019);
+
+static size_t allocations = 0;
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+static const int CAP = 64;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size() || ans.empty() != test.empty())
+        return false;
+    for (size_t i = 0; i < ans.size(); i++)
+        if (!(ans[i] == test[i]) || !(ans.at(i) == *(test.cbegin() + i)))
+            return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+bool pushPopTest() {
+    std::deque<int> ans;
+    sjtu::static_deque<int, CAP> deq;
+    for (int i = 0; i < 100000; i++) {
+        int x = randnum();
+        switch (randnum() % 4) {
+            case 0:
+                if (ans.size() < CAP)
+                    ans.push_back(x), deq.push_back(x);
+                break;
+            case 1:
+                if (ans.size() < CAP)
+                    ans.push_front(x), deq.push_front(x);
+                break;
+            case 2:
+                if (!ans.empty())
+                    ans.pop_back(), deq.pop_back();
+                break;
+            case 3:
+                if (!ans.empty())
+                    ans.pop_front(), deq.pop_front();
+                break;
+        }
+        if (i % 1000 == 0 && !isEqual(ans, deq))
+            return false;
+    }
+    return isEqual(ans, deq);
+}
+
+bool insertEraseTest() {
+    std::deque<int> ans;
+    sjtu::static_deque<int, CAP> deq;
+    for (int i = 0; i < 100000; i++) {
+        int x = randnum();
+        size_t pos = randnum() % (ans.size() + 1);
+        if (ans.size() < CAP && randnum() % 2) {
+            auto it = deq.insert(deq.begin() + pos, x);
+            ans.insert(ans.begin() + pos, x);
+            if (*it != x || it - deq.begin() != pos)
+                return false;
+        } else if (pos < ans.size()) {
+            auto it = deq.erase(deq.begin() + pos);
+            ans.erase(ans.begin() + pos);
+            if (pos < ans.size() ? *it != ans[pos] : it != deq.end())
+                return false;
+        }
+        if (i % 1000 == 0 && !isEqual(ans, deq))
+            return false;
+    }
+    // inserting an element of the deque itself
+    while (!ans.empty())
+        ans.pop_back(), deq.pop_back();
+    for (int i = 0; i < 10; i++)
+        ans.push_back(i), deq.push_back(i);
+    ans.insert(ans.begin() + 2, ans[7]);
+    deq.insert(deq.begin() + 2, deq[7]);
+    ans.insert(ans.begin() + 9, ans[1]);
+    deq.insert(deq.begin() + 9, deq[1]);
+    return isEqual(ans, deq);
+}
+
+bool noHeapTest() {
+    size_t before = allocations;
+    sjtu::static_deque<Integer, CAP> deq;
+    for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < CAP; i++)
+            round % 2 ? deq.push_back(Integer(i)) : deq.push_front(Integer(i));
+        auto it = deq.begin() + CAP / 2;
+        it = deq.erase(it);
+        deq.insert(it, Integer(round));
+        sjtu::static_deque<Integer, CAP> copy(deq);
+        while (!copy.empty())
+            copy.pop_front();
+        deq.clear();
+    }
+    return allocations == before;
+}
+
+bool errorTest() {
+    sjtu::static_deque<int, 4> deq, other;
+    int successCounter = 0;
+    try {
+        deq.front();
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.pop_back();
+    } catch (...) {
+        successCounter++;
+    }
+    for (int i = 0; i < 4; i++)
+        deq.push_back(i);
+    try {
+        deq.push_front(0);
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.insert(deq.begin(), 0);
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.at(4);
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        *deq.end();
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.erase(other.begin());
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        deq.begin() - other.begin();
+    } catch (...) {
+        successCounter++;
+    }
+    return successCounter == 8 && deq.full() && deq.capacity() == 4;
+}
+
+bool spillTest() {
+    sjtu::static_deque<Diamond::Matrix<double>, 8> deq;
+    for (int i = 0; i < 8; i++)
+        deq.push_back(Diamond::Matrix<double>(i + 1, i + 2, i * 0.5));
+    sjtu::deque<Diamond::Matrix<double>> big = deq.to_deque();
+    for (int i = 8; i < 100; i++)
+        big.push_back(Diamond::Matrix<double>(2, 2, i * 0.5));
+    if (big.size() != 100)
+        return false;
+    for (int i = 0; i < 8; i++)
+        if (!(big[i] == deq[i]))
+            return false;
+    return true;
+}
+
+int main() {
+    bool (*testFunc[])() = {pushPopTest, insertEraseTest, noHeapTest,
+                            errorTest, spillTest};
+
+    const char* testMessage[] = {
+        "Testing push and pop...",   "Testing insert and erase...",
+        "Testing heap usage...",     "Testing errors...",
+        "Testing conversion...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
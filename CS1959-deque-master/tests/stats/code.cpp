@@ -0,0 +1,151 @@
+// memory_stats: the reported bytes match what the deque allocated.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241111);
+
+// every allocation is prefixed with its size, so live bytes can be counted
+static size_t live_bytes = 0;
+static const size_t PREFIX = 64;
+static void* counted_alloc(size_t size) {
+    char* ptr = static_cast<char*>(std::aligned_alloc(
+        PREFIX, (size + 2 * PREFIX - 1) / PREFIX * PREFIX));
+    if (!ptr)
+        throw std::bad_alloc();
+    std::memcpy(ptr, &size, sizeof(size));
+    live_bytes += size;
+    return ptr + PREFIX;
+}
+static void counted_free(void* ptr) {
+    if (!ptr)
+        return;
+    char* base = static_cast<char*>(ptr) - PREFIX;
+    size_t size;
+    std::memcpy(&size, base, sizeof(size));
+    live_bytes -= size;
+    std::free(base);
+}
+void* operator new(size_t size) { return counted_alloc(size); }
+void* operator new(size_t size, std::align_val_t) { return counted_alloc(size); }
+// the deque allocates its ring through the nothrow form
+void* operator new(size_t size, std::align_val_t,
+                   const std::nothrow_t&) noexcept {
+    try {
+        return counted_alloc(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void operator delete(void* ptr) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { counted_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { counted_free(ptr); }
+
+template <typename Deque>
+bool matches(const Deque& deq, size_t before) {
+    sjtu::deque_stats st = deq.memory_stats();
+    return st.element_bytes + st.overhead_bytes == live_bytes - before;
+}
+
+bool flatTest() {
+    size_t before = live_bytes;
+    sjtu::deque<long long> deq;
+    for (int i = 0; i < 1000; i++)
+        deq.push_back(i);
+    sjtu::deque_stats st = deq.memory_stats(4);
+    return st.flat && st.element_bytes == 1000 * sizeof(long long) &&
+           st.spare_capacity == deq.ring_cap - 1000 && !st.blocks &&
+           st.histogram.empty() && matches(deq, before);
+}
+
+bool inlineTest() {
+    size_t before = live_bytes;
+    sjtu::deque<int, 32> deq;
+    for (int i = 0; i < 20; i++)
+        deq.push_front(i);
+    sjtu::deque_stats st = deq.memory_stats();
+    return live_bytes == before && !st.overhead_bytes &&
+           st.spare_capacity == 12 && st.element_bytes == 20 * sizeof(int);
+}
+
+bool blockTest() {
+    size_t before = live_bytes;
+    sjtu::deque<int> deq;
+    for (int i = 0; i < 2 * FLAT_CAPACITY; i++)
+        deq.push_back(i);
+    for (int i = 0; i < 20000; i++)
+        deq.erase(deq.begin() + randnum() % deq.size());
+    for (int i = 0; i < 3000; i++)
+        deq.pop_front();
+    if (!matches(deq, before))
+        return false;
+    const size_t buckets = 8;
+    sjtu::deque_stats st = deq.memory_stats(buckets);
+    if (st.flat || st.blocks != deq.list.size)
+        return false;
+    size_t counted = 0, fill = 0;
+    for (size_t i = 0; i < buckets; i++)
+        counted += st.histogram[i];
+    for (auto it = deq.list.begin(); it != deq.list.end(); ++it) {
+        fill += it->size;
+        if (it->size < st.min_fill || it->size > st.max_fill)
+            return false;
+    }
+    return counted == st.blocks && fill == deq.size() &&
+           std::fabs(st.mean_fill * st.blocks - deq.size()) < 1e-6 &&
+           st.elements == deq.size() &&
+           st.overhead_per_element() > (double)sizeof(sjtu::deque<int>::Node);
+}
+
+bool spareTest() {
+    size_t before = live_bytes;
+    sjtu::deque<Diamond::Matrix<double>> deq;
+    deq.reserve(3 * FLAT_CAPACITY);
+    for (int i = 0; i < 100; i++)
+        deq.push_back(Diamond::Matrix<double>(1, 1, i));
+    sjtu::deque_stats st = deq.memory_stats();
+    if (!st.spare_blocks || st.spare_capacity < st.spare_blocks)
+        return false;
+    deq.shrink_to_fit();
+    st = deq.memory_stats();
+    return !st.spare_blocks && !st.spare_capacity && st.blocks &&
+           live_bytes - before >= st.element_bytes + st.overhead_bytes;
+}
+
+int main() {
+    bool (*testFunc[])() = {flatTest, inlineTest, blockTest, spareTest};
+
+    const char* testMessage[] = {
+        "Testing flat mode...",
+        "Testing inline slots...",
+        "Testing block mode...",
+        "Testing spare blocks...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
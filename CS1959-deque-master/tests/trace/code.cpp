@@ -0,0 +1,136 @@
+// operation counters and the structural event hook, built with DEQUE_TRACE.
+
+#define DEQUE_TRACE
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241115);
+
+class event_log {
+   public:
+    size_t count[7] = {};
+    size_t moved[7] = {};
+};
+void record(void* context, sjtu::deque_event event, size_t elements) {
+    event_log* log = static_cast<event_log*>(context);
+    ++log->count[(int)event];
+    log->moved[(int)event] += elements;
+}
+size_t of(const size_t* arr, sjtu::deque_event event) {
+    return arr[(int)event];
+}
+
+template <typename Deque>
+bool blocksAddUp(const Deque& deq) {
+    return deq.counters.blocks_allocated - deq.counters.blocks_freed ==
+           deq.list.size + deq.spare_count;
+}
+
+bool counterTest() {
+    sjtu::deque<int> deq;
+    for (int i = 0; i < 2 * FLAT_CAPACITY; i++)
+        deq.push_back(i);
+    const sjtu::deque_counters& c = deq.counters;
+    if (c.spills != 1 || !c.ring_resizes || !c.expands ||
+        c.expand_moved < c.expands || !blocksAddUp(deq))
+        return false;
+    deq.reset_counters();
+    long long sum = 0;
+    for (int i = 0; i < 1000; i++)
+        sum += deq[randnum() % deq.size()];
+    if (c.at_calls != 1000 || !c.walk_blocks || !c.walk_nodes)
+        return false;
+    deq.reset_counters();
+    auto it = deq.end() - 1;
+    if (it - deq.begin() != deq.size() - 1 || !c.step_blocks ||
+        c.step_nodes < deq.size())
+        return false;
+    deq.reset_counters();
+    for (int i = 0; i < 20000; i++)
+        deq.erase(deq.begin() + randnum() % deq.size());
+    return c.compresses && c.compress_moved && sum;
+}
+
+bool hookTest() {
+    event_log log;
+    {
+        sjtu::deque<Diamond::Matrix<double>> deq;
+        deq.set_trace_hook(record, &log);
+        std::deque<Diamond::Matrix<double>> ans;
+        for (int i = 0; i < FLAT_CAPACITY + 5000; i++) {
+            Diamond::Matrix<double> m(1, 1, i);
+            deq.push_front(m), ans.push_front(m);
+        }
+        for (int i = 0; i < 5000; i++) {
+            size_t pos = randnum() % ans.size();
+            deq.erase(deq.begin() + pos), ans.erase(ans.begin() + pos);
+        }
+        deq.rotate(deq.size() / 3);
+        std::rotate(ans.begin(), ans.begin() + ans.size() / 3, ans.end());
+        const sjtu::deque_counters& c = deq.counters;
+        if (of(log.count, sjtu::deque_event::spill) != c.spills ||
+            of(log.count, sjtu::deque_event::block_alloc) !=
+                c.blocks_allocated ||
+            of(log.count, sjtu::deque_event::block_free) != c.blocks_freed ||
+            of(log.count, sjtu::deque_event::block_merge) != c.compresses ||
+            of(log.moved, sjtu::deque_event::block_merge) != c.compress_moved ||
+            of(log.count, sjtu::deque_event::block_split) <= c.expands ||
+            !blocksAddUp(deq))
+            return false;
+        for (size_t i = 0; i < ans.size(); i++)
+            if (!(deq[i] == ans[i]))
+                return false;
+        while (deq.size() > 100)
+            deq.pop_back();
+        if (!deq.flat || !of(log.count, sjtu::deque_event::collapse))
+            return false;
+    }
+    // every allocated block was freed again
+    return of(log.count, sjtu::deque_event::block_alloc) ==
+           of(log.count, sjtu::deque_event::block_free);
+}
+
+bool copyTest() {
+    sjtu::deque<int> deq;
+    for (int i = 0; i < 2 * FLAT_CAPACITY; i++)
+        deq.push_front(i);
+    sjtu::deque<int> other(deq), third;
+    third = other;
+    third.clear();
+    return blocksAddUp(deq) && blocksAddUp(other) && blocksAddUp(third) &&
+           other.counters.blocks_allocated == other.list.size;
+}
+
+int main() {
+    bool (*testFunc[])() = {counterTest, hookTest, copyTest};
+
+    const char* testMessage[] = {
+        "Testing counters...",
+        "Testing event hook...",
+        "Testing copies...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+// swap and transfer_front / transfer_back between deques.
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241109);
+
+static size_t allocations = 0;
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+// large enough to stay in the block layout
+static const int N = FLAT_CAPACITY + 10000;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+// move n elements from the front of a to the back of b, or the reverse
+template <typename Ans, typename Test>
+void transfer(Ans& a, Ans& b, Test& x, Test& y, bool front, size_t n) {
+    if (front) {
+        x.transfer_front(y, n);
+        for (size_t i = 0; i < n; i++)
+            b.push_back(a.front()), a.pop_front();
+    } else {
+        y.transfer_back(x, n);
+        for (size_t i = 0; i < n; i++)
+            a.push_front(b.back()), b.pop_back();
+    }
+}
+
+template <typename T, typename Make>
+bool randomTest(int size, Make make) {
+    std::deque<T> a, b;
+    sjtu::deque<T> x, y;
+    for (int i = 0; i < size; i++) {
+        T v = make(i);
+        a.push_back(v), x.push_back(v);
+    }
+    for (int round = 0; round < 60; round++) {
+        bool front = randnum() % 2;
+        size_t avail = front ? a.size() : b.size();
+        size_t n = randnum() % (avail + 1);
+        if (round % 5 == 0)
+            n = avail;
+        transfer(a, b, x, y, front, n);
+        if (!isEqual(a, x) || !isEqual(b, y))
+            return false;
+        if (round % 3 == 0) {
+            T v = make(round);
+            a.push_front(v), x.push_front(v);
+            b.push_back(v), y.push_back(v);
+        }
+    }
+    x.transfer_front(x, x.size() / 3);
+    for (size_t i = a.size() / 3; i; i--)
+        a.push_back(a.front()), a.pop_front();
+    return isEqual(a, x) && isEqual(b, y);
+}
+
+bool blockTest() {
+    return randomTest<int>(N, [](int i) { return i; });
+}
+
+bool flatTest() {
+    return randomTest<int>(1000, [](int i) { return i; });
+}
+
+bool classTest() {
+    return randomTest<Diamond::Matrix<double>>(
+        N / 4, [](int i) { return Diamond::Matrix<double>(1, 2, i * 0.5); });
+}
+
+// each transfer allocates at most the boundary block: its node and list
+bool allocTest() {
+    sjtu::deque<int> x, y;
+    for (int i = 0; i < 4 * N; i++)
+        x.push_back(i), y.push_back(-i);
+    size_t before = allocations;
+    x.transfer_front(y, 2 * N + 7);
+    y.transfer_back(x, N + 3);
+    if (allocations - before > 4)
+        return false;
+    return x.size() == 3 * N - 4 && y.size() == 5 * N + 4 &&
+           x.front() == N + 4 && x.back() == 4 * N - 1 &&
+           y.front() == 0 && y.back() == N + 3;
+}
+
+// counts the copies made of it, moves are free
+class tracked {
+   public:
+    static size_t copies;
+    int v;
+    tracked(int v = 0) : v(v) {}
+    tracked(const tracked& other) : v(other.v) { ++copies; }
+    tracked(tracked&& other) noexcept : v(other.v) {}
+    tracked& operator=(const tracked& other) {
+        v = other.v;
+        ++copies;
+        return *this;
+    }
+    tracked& operator=(tracked&& other) noexcept {
+        v = other.v;
+        return *this;
+    }
+};
+size_t tracked::copies = 0;
+
+// nothing is copied, and a small target is not turned back into a ring
+bool moveTest() {
+    sjtu::deque<tracked> x, y;
+    for (int i = 0; i < N; i++)
+        x.push_back(tracked(i));
+    y.push_back(tracked(-1));
+    tracked::copies = 0;
+    // one by one below a block, then whole blocks into a flat y
+    x.transfer_front(y, 3);
+    x.transfer_front(y, 5000);
+    x.transfer_back(y, 2);
+    return tracked::copies == 0 && !y.flat && y.size() == 5006 &&
+           y.front().v == N - 2 && y.back().v == 5002 && x.front().v == 5003;
+}
+
+// swap every combination of inline, heap ring and block layout
+bool swapTest() {
+    typedef sjtu::deque<int, 8> dq;
+    const int sizes[] = {0, 3, 8, 100, N};
+    for (int s1 : sizes)
+        for (int s2 : sizes) {
+            std::deque<int> a, b;
+            dq x, y;
+            for (int i = 0; i < s1; i++)
+                a.push_front(i), x.push_front(i);
+            for (int i = 0; i < s2; i++)
+                b.push_back(-i), y.push_back(-i);
+            swap(x, y);
+            if (!isEqual(a, y) || !isEqual(b, x))
+                return false;
+            x.push_back(1), b.push_back(1);
+            y.push_front(2), a.push_front(2);
+            x.swap(x);
+            if (!isEqual(a, y) || !isEqual(b, x))
+                return false;
+        }
+    return true;
+}
+
+bool exceptionTest() {
+    sjtu::deque<int> x, y;
+    x.push_back(1);
+    try {
+        x.transfer_front(y, 2);
+    } catch (sjtu::index_out_of_bound&) {
+        return x.size() == 1 && y.empty();
+    }
+    return false;
+}
+
+int main() {
+    bool (*testFunc[])() = {blockTest, flatTest, classTest,    allocTest,
+                            moveTest,  swapTest, exceptionTest};
+
+    const char* testMessage[] = {
+        "Testing transfer of blocks...",
+        "Testing transfer of flat deques...",
+        "Testing class elements...",
+        "Testing allocations of transfer...",
+        "Testing moves of transfer...",
+        "Testing swap...",
+        "Testing exceptions...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+// try_pop_front/try_pop_back/try_front/try_back/try_at: empty deques and
+// bad indices are reported through the return value, nothing is thrown.
+
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <type_traits>
+#include <utility>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241123);
+
+static_assert(noexcept(std::declval<sjtu::deque<int>&>().try_pop_front()),
+              "try_pop_front must not throw for int");
+static_assert(noexcept(std::declval<sjtu::deque<long long>&>().try_at(0)),
+              "try_at must not throw for long long");
+static_assert(std::is_same<decltype(std::declval<const sjtu::deque<int>&>()
+                                        .unchecked_front()),
+                           const int&>::value,
+              "a const deque must not hand out mutable references");
+static_assert(std::is_same<decltype(std::declval<sjtu::deque<int>&>()
+                                        .unchecked_back()),
+                           int&>::value,
+              "a mutable deque hands out mutable references");
+
+template <class Deque>
+bool queueTest(int n) {
+    std::deque<int> ans;
+    Deque deq;
+    int out = -1;
+    // start a large queue in block mode
+    for (int i = 0; i < n / 2; i++)
+        ans.push_back(i), deq.push_back(i);
+    for (int i = 0; i < 200000; i++) {
+        int x = randnum();
+        switch (randnum() % 6) {
+            case 0:
+            case 1:
+                if (ans.size() < n)
+                    ans.push_back(x), deq.push_back(x);
+                break;
+            case 2:
+                if (ans.size() < n)
+                    ans.push_front(x), deq.push_front(x);
+                break;
+            case 3:
+                if (deq.try_pop_front(out) != !ans.empty())
+                    return false;
+                if (!ans.empty()) {
+                    if (out != ans.front())
+                        return false;
+                    ans.pop_front();
+                }
+                break;
+            case 4:
+                if (deq.try_pop_back() != !ans.empty())
+                    return false;
+                if (!ans.empty())
+                    ans.pop_back();
+                break;
+            case 5: {
+                size_t pos = randnum() % (ans.size() + 2);
+                std::optional<int> val = deq.try_at(pos);
+                if (val.has_value() != pos < ans.size() ||
+                    (val && *val != ans[pos]))
+                    return false;
+                if (deq.try_front().has_value() == ans.empty() ||
+                    (!ans.empty() && (*deq.try_front() != ans.front() ||
+                                      *deq.try_back() != ans.back())))
+                    return false;
+                break;
+            }
+        }
+    }
+    return ans.size() == deq.size() && (n < FLAT_CAPACITY || !deq.flat);
+}
+
+bool emptyTest() {
+    sjtu::deque<Diamond::Matrix<double>> deq;
+    Diamond::Matrix<double> out(1, 1, 7);
+    if (deq.try_pop_front(out) || deq.try_pop_back(out) || deq.try_pop_front() ||
+        deq.try_pop_back() || deq.try_front() || deq.try_back() ||
+        deq.try_at(0) || !(out == Diamond::Matrix<double>(1, 1, 7)))
+        return false;
+    for (int i = 0; i < FLAT_CAPACITY + 100; i++)
+        deq.push_back(Diamond::Matrix<double>(1, 2, i));
+    int i = 0;
+    while (deq.try_pop_front(out)) {
+        if (!(out == Diamond::Matrix<double>(1, 2, i++)))
+            return false;
+    }
+    return i == FLAT_CAPACITY + 100 && deq.empty() && deq.flat &&
+           !deq.try_at(FLAT_CAPACITY);
+}
+
+int main() {
+    bool (*testFunc[])() = {[] { return queueTest<sjtu::deque<int>>(64); },
+                            [] { return queueTest<sjtu::deque<int>>(FLAT_CAPACITY * 2); },
+                            [] { return queueTest<sjtu::deque<int, 16>>(40); },
+                            emptyTest};
+
+    const char* testMessage[] = {
+        "Testing small queue...",
+        "Testing large queue...",
+        "Testing inline slots...",
+        "Testing empty deque...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
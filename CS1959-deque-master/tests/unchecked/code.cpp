@@ -0,0 +1,135 @@
+// unchecked_access: operator[] and the iterators skip their checks,
+// at() still checks.
+
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <random>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241119);
+
+template <class T>
+using fast_deque =
+    sjtu::deque<T, 0, sjtu::page_block_policy, sjtu::unchecked_access>;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    const Test& ctest = test;
+    for (size_t i = 0; i < ans.size(); i++)
+        if (!(ans[i] == test[i]) || !(ans[i] == ctest[i]) ||
+            !(ans[i] == test.unchecked_at(i)))
+            return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); ++it, i++)
+        if (!(*it == ans[i]))
+            return false;
+    i = 0;
+    for (auto it = test.cbegin(); it != test.cend(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    if (i != ans.size())
+        return false;
+    i = ans.size();
+    for (auto it = test.end(); it != test.begin();)
+        if (!(*--it == ans[--i]))
+            return false;
+    return true;
+}
+
+template <class Deque>
+bool accessTest() {
+    std::deque<int> ans;
+    Deque deq;
+    for (int round = 0; round < 3; round++) {
+        int n = round == 1 ? 2 * FLAT_CAPACITY : 1000;
+        for (int i = 0; i < n; i++) {
+            int x = randnum();
+            if (randnum() % 2)
+                ans.push_back(x), deq.push_back(x);
+            else
+                ans.push_front(x), deq.push_front(x);
+        }
+        for (int i = 0; i < 1000; i++) {
+            size_t pos = randnum() % ans.size();
+            deq[pos] = ans[pos] = randnum();
+        }
+        if (!isEqual(ans, deq))
+            return false;
+        while (ans.size() > 10)
+            ans.pop_front(), deq.pop_front();
+    }
+    return isEqual(ans, deq);
+}
+
+bool boundTest() {
+    fast_deque<Diamond::Matrix<double>> deq;
+    sjtu::deque<Diamond::Matrix<double>> checked;
+    int successCounter = 0;
+    for (int i = 0; i < 2 * FLAT_CAPACITY; i++) {
+        deq.push_back(Diamond::Matrix<double>(1, 1, i));
+        checked.push_back(Diamond::Matrix<double>(1, 1, i));
+    }
+    try {
+        deq.at(deq.size());
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        checked[checked.size()];
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        ++checked.end();
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        --checked.begin();
+    } catch (...) {
+        successCounter++;
+    }
+    try {
+        *checked.cend();
+    } catch (...) {
+        successCounter++;
+    }
+    return successCounter == 5 &&
+           deq[deq.size() - 1] == Diamond::Matrix<double>(1, 1, deq.size() - 1) &&
+           deq.begin()->RowSize() == 1;
+}
+
+int main() {
+    bool (*testFunc[])() = {accessTest<sjtu::deque<int>>,
+                            accessTest<fast_deque<int>>, boundTest};
+
+    const char* testMessage[] = {
+        "Testing checked access...",
+        "Testing unchecked access...",
+        "Testing bound checks...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,208 @@
+// adopt() a std::vector into a deque and move it back with into_vector().
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "class-integer.hpp"
+#include "class-matrix.hpp"
+#include "deque.hpp"
+
+std::default_random_engine randnum(20241215);
+
+// plain allocations are counted, aligned ones (the ring) are not; every
+// form is replaced so that each delete matches its new. the plain new
+// and delete are kept out of line, or gcc pairs the malloc and free in
+// them with the new and delete expressions and warns of a mismatch
+static size_t allocations = 0;
+__attribute__((noinline)) void* operator new(size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, std::align_val_t align) {
+    size_t a = (size_t)align;
+    if (void* ptr = std::aligned_alloc(a, (size + a - 1) / a * a))
+        return ptr;
+    throw std::bad_alloc();
+}
+// the deque allocates its ring through the nothrow form
+void* operator new(size_t size, std::align_val_t align,
+                   const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size, align);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept { ::operator delete(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t align) noexcept {
+    ::operator delete(ptr, align);
+}
+
+static const int N = FLAT_CAPACITY + 10000;
+
+template <typename Ans, typename Test>
+bool isEqual(Ans& ans, Test& test) {
+    if (ans.size() != test.size())
+        return false;
+    size_t i = 0;
+    for (auto it = test.begin(); it != test.end(); it++, i++)
+        if (!(*it == ans[i]))
+            return false;
+    return ans.empty() ||
+           (ans.front() == test.front() && ans.back() == test.back());
+}
+
+// adopt, change both ends, and move out again
+template <typename T, typename Deque, typename Make>
+bool roundTrip(size_t n, Make make) {
+    std::vector<T> v;
+    std::deque<T> a;
+    for (size_t i = 0; i < n; i++)
+        v.push_back(make(i)), a.push_back(make(i));
+    Deque x;
+    x.push_back(make(7));
+    x.adopt(std::move(v));
+    if (!v.empty() || v.capacity() || !isEqual(a, x))
+        return false;
+    for (size_t i = 0; i < 50; i++) {
+        x.push_front(make(i)), a.push_front(make(i));
+        x.pop_back(), a.pop_back();
+    }
+    std::vector<T> w = x.into_vector();
+    if (!x.empty() || !isEqual(a, w))
+        return false;
+    x.push_back(make(1)), a.clear(), a.push_back(make(1));
+    return isEqual(a, x);
+}
+
+bool flatTest() {
+    for (size_t n : {0, 1, 16, 1000, FLAT_CAPACITY})
+        if (!roundTrip<int, sjtu::deque<int>>(n, [](size_t i) { return i; }))
+            return false;
+    return true;
+}
+
+bool blockTest() {
+    return roundTrip<int, sjtu::deque<int>>(N, [](size_t i) { return i; }) &&
+           roundTrip<long long, sjtu::deque<long long>>(
+               3 * N, [](size_t i) { return i * i; });
+}
+
+bool inlineTest() {
+    typedef sjtu::deque<int, 8> dq;
+    for (size_t n : {0, 5, 8, 9, 100, N})
+        if (!roundTrip<int, dq>(n, [](size_t i) { return -(int)i; }))
+            return false;
+    return true;
+}
+
+bool classTest() {
+    auto make = [](size_t i) { return Diamond::Matrix<double>(1, 2, i * 0.5); };
+    return roundTrip<Diamond::Matrix<double>,
+                     sjtu::deque<Diamond::Matrix<double>>>(1000, make) &&
+           roundTrip<Diamond::Matrix<double>,
+                     sjtu::deque<Diamond::Matrix<double>>>(N, make) &&
+           roundTrip<Integer, sjtu::deque<Integer>>(
+               500, [](size_t i) { return Integer(i); });
+}
+
+// a flat round trip allocates the ring, through the aligned operator new
+// that is not counted here, and the vector: no nodes and no blocks
+bool allocTest() {
+    std::vector<int> v(FLAT_CAPACITY / 2, 3);
+    v[100] = 4;
+    sjtu::deque<int> x;
+    size_t before = allocations;
+    x.adopt(std::move(v));
+    if (allocations - before != 0)
+        return false;
+    x.pop_front(), x.push_back(5);
+    before = allocations;
+    std::vector<int> w = x.into_vector();
+    return allocations - before == 1 && w.size() == FLAT_CAPACITY / 2 &&
+           w[99] == 4 && w.back() == 5;
+}
+
+// the ring wraps around before it is moved out
+bool wrapTest() {
+    std::deque<int> a;
+    sjtu::deque<int> x;
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 300; i++) {
+            int v = randnum() % 1000;
+            if (randnum() % 2)
+                x.push_front(v), a.push_front(v);
+            else
+                x.push_back(v), a.push_back(v);
+        }
+        for (int i = randnum() % 200; i; i--)
+            x.pop_back(), a.pop_back();
+        std::vector<int> w = x.into_vector();
+        if (!isEqual(a, w))
+            return false;
+        x.adopt(std::move(w));
+        if (!isEqual(a, x))
+            return false;
+    }
+    return true;
+}
+
+// adopting replaces the elements, not the rank index or the spare blocks
+bool settingsTest() {
+    sjtu::deque<int> x;
+    x.enable_rank_index();
+    x.reserve(3 * N);
+    size_t spares = x.spare_count, limit = x.spare_limit;
+    std::vector<int> v;
+    for (int i = 0; i < N; i++)
+        v.push_back(N - i);
+    x.adopt(std::move(v));
+    return x.rank_index && spares && x.spare_count == spares &&
+           x.spare_limit == limit && x.count_less(0, N, 100) == 99 &&
+           x.size() == N && x.front() == N;
+}
+
+int main() {
+    bool (*testFunc[])() = {flatTest,  blockTest, inlineTest,
+                            classTest, allocTest, wrapTest,
+                            settingsTest};
+
+    const char* testMessage[] = {
+        "Testing flat deques...",
+        "Testing block deques...",
+        "Testing inline deques...",
+        "Testing class elements...",
+        "Testing allocations...",
+        "Testing wrapped rings...",
+        "Testing kept settings...",
+    };
+
+    bool error = false;
+    for (int i = 0; i < sizeof(testFunc) / sizeof(testFunc[0]); i++) {
+        printf("%-40s", testMessage[i]);
+        if (testFunc[i]())
+            printf("Passed\n");
+        else {
+            error = true;
+            printf("Failed !!!\n");
+        }
+    }
+
+    if (error)
+        printf("\nUnfortunately, you failed in this test\n\a");
+    else
+        printf("\nCongratulations, your deque passed all the tests!\n");
+
+    return 0;
+}
@@ -0,0 +1,317 @@
+#ifndef SJTU_TEXT_LOADER_HPP
+#define SJTU_TEXT_LOADER_HPP
+#include "deque.hpp"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <istream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Util {
+class Bint;
+}
+
+namespace sjtu {
+/**
+ * how the text loader turns one whitespace-free token into a T.
+ * the default goes through operator>>; numbers and Bint are parsed
+ * straight from the buffer. throw runtime_error on a bad token.
+ */
+template <class T, class Enable = void>
+class text_parser {
+   public:
+    static T parse(const char* first, const char* last) {
+        std::istringstream is(std::string(first, last));
+        T value;
+        if (!(is >> value))
+            throw runtime_error("load_text: bad token");
+        return value;
+    }
+};
+template <class T>
+class text_parser<T, std::enable_if_t<std::is_arithmetic<T>::value &&
+                                      !std::is_same<T, bool>::value>> {
+   public:
+    static T parse(const char* first, const char* last) {
+        T value;
+        if (*first == '+' && last - first > 1)
+            ++first;  // from_chars takes no plus sign
+        auto [end, ec] = std::from_chars(first, last, value);
+        if (ec != std::errc() || end != last)
+            throw runtime_error("load_text: bad token");
+        return value;
+    }
+};
+// Bint only parses from a std::string, so the token is copied into one
+// once, without the istream around it
+template <>
+class text_parser<Util::Bint> {
+   public:
+    template <class B = Util::Bint>
+    static B parse(const char* first, const char* last) {
+        try {
+            return B(std::string(first, last));
+        } catch (std::invalid_argument&) {
+            throw runtime_error("load_text: bad token");
+        }
+    }
+};
+
+// a source that cannot be interrupted, see chunk_reader
+class no_cancel {
+   public:
+    void operator()() const {}
+};
+
+/**
+ * reads a source in large chunks on a second thread while the caller
+ * parses the previous ones. Read is size_t(char* buf, size_t bytes),
+ * returning 0 at the end; it runs on the reader thread.
+ * the destructor calls cancel() and then waits for the reader, so if
+ * the caller stops early, say on a bad token, cancel must make a read
+ * in progress return soon; with no_cancel, Read must never block for
+ * long (a pipe or a terminal with no writer behind it would hang).
+ */
+template <class Read, class Cancel = no_cancel>
+class chunk_reader {
+   public:
+    static constexpr size_t chunks = 3;
+    Read read;
+    Cancel cancel;
+    size_t chunk_bytes;
+    std::vector<std::vector<char>> buffers;
+    // filled[i] is the byte count of buffers[i], or -1 while it is free
+    std::vector<size_t> filled;
+    size_t published = 0;  // chunks handed to the parser so far
+    size_t parsed = 0;     // chunks the parser has taken
+    bool done = false;     // the last chunk is published
+    bool failed = false;   // ... and the read that ended it failed
+    bool stop = false;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread thread;
+
+    chunk_reader(Read read, size_t chunk_bytes, Cancel cancel = Cancel())
+        : read(read), cancel(cancel), chunk_bytes(chunk_bytes),
+          buffers(chunks, std::vector<char>(chunk_bytes)),
+          filled(chunks, (size_t)-1) {
+        thread = std::thread([this] { run(); });
+    }
+    ~chunk_reader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cond.notify_all();
+        cancel();
+        thread.join();
+    }
+    void run() {
+        for (size_t i = 0; !done; i = (i + 1) % chunks) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock,
+                          [&] { return stop || filled[i] == (size_t)-1; });
+                if (stop)
+                    return;
+            }
+            // fill the chunk, so that only the last one is short
+            size_t bytes = 0;
+            bool error = false;
+            try {
+                for (size_t got = 1; got && bytes < chunk_bytes; bytes += got)
+                    got = read(buffers[i].data() + bytes, chunk_bytes - bytes);
+            } catch (...) {
+                error = true;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            filled[i] = bytes;
+            ++published;
+            done = failed = error;
+            done |= bytes < chunk_bytes;
+            cond.notify_all();
+        }
+    }
+    /**
+     * the next chunk and its size, or nullptr at the end.
+     * the chunk stays the caller's until the next call.
+     * throw runtime_error if the source failed.
+     */
+    const char* next(size_t& bytes) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (parsed) {
+            filled[(parsed - 1) % chunks] = (size_t)-1;
+            cond.notify_all();
+        }
+        cond.wait(lock, [&] { return parsed < published || done; });
+        if (parsed == published)
+            return nullptr;
+        if (failed && parsed + 1 == published)
+            throw runtime_error("load_text: read failed");
+        bytes = filled[parsed % chunks];
+        return buffers[parsed++ % chunks].data();
+    }
+};
+
+/**
+ * append the whitespace-separated values read by read, see chunk_reader,
+ * to the back of dst, returning how many.
+ * the source is read in chunks of chunk_bytes on a second thread while
+ * this one parses, and the values are moved in a batch at a time with
+ * deque::append, which fills whole blocks at once. they cannot be
+ * parsed straight into the blocks: a block holds one node and one heap
+ * T an element, which append allocates as it moves each value in.
+ * throw runtime_error if the source cannot be read or a token does not
+ * parse; the values before it have been appended then. cancel is
+ * called before returning early, see chunk_reader.
+ */
+template <class Deque, class Read, class Cancel = no_cancel>
+size_t load_chunks(Deque& dst, Read read, size_t chunk_bytes = 1 << 20,
+                   Cancel cancel = Cancel()) {
+    using T = typename std::decay<decltype(dst.front())>::type;
+    static const size_t batch_size = 4096;
+    chunk_reader<Read, Cancel> reader(read, chunk_bytes, cancel);
+    std::vector<T> batch;
+    batch.reserve(batch_size);
+    size_t count = 0;
+    // a token cut at the end of a chunk, waiting for the rest
+    std::string carry;
+    auto flush = [&] {
+        count += batch.size();
+        dst.append(batch.begin(), batch.end());
+        batch.clear();
+    };
+    auto token = [&](const char* first, const char* last) {
+        batch.push_back(text_parser<T>::parse(first, last));
+        if (batch.size() == batch_size)
+            flush();
+    };
+    auto space = [](char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f' ||
+               c == '\v';
+    };
+    size_t bytes;
+    try {
+        while (const char* buf = reader.next(bytes)) {
+            const char *p = buf, *end = buf + bytes;
+            if (!carry.empty()) {
+                while (p != end && !space(*p))
+                    carry += *p++;
+                if (p == end)
+                    continue;
+                token(carry.data(), carry.data() + carry.size());
+                carry.clear();
+            }
+            while (true) {
+                while (p != end && space(*p))
+                    ++p;
+                const char* start = p;
+                while (p != end && !space(*p))
+                    ++p;
+                if (p == end) {
+                    carry.assign(start, end);
+                    break;
+                }
+                token(start, p);
+            }
+        }
+        if (!carry.empty())
+            token(carry.data(), carry.data() + carry.size());
+    } catch (...) {
+        flush();  // keep the values before the failure
+        throw;
+    }
+    flush();
+    return count;
+}
+/**
+ * the same from a file descriptor, read with read(2).
+ * the reader polls fd together with a pipe of its own, and an early
+ * return writes to that pipe, so a pipe or a terminal that has not
+ * sent the rest of its input does not hold it up.
+ */
+template <class Deque>
+size_t load_text(Deque& dst, int fd, size_t chunk_bytes = 1 << 20) {
+    int wake[2];
+    if (::pipe(wake) != 0)
+        throw runtime_error("load_text: cannot create pipe");
+    try {
+        size_t count = load_chunks(
+            dst,
+            [fd, wake](char* buf, size_t bytes) -> size_t {
+                pollfd fds[2] = {{fd, POLLIN, 0}, {wake[0], POLLIN, 0}};
+                while (::poll(fds, 2, -1) < 0)
+                    if (errno != EINTR)
+                        throw runtime_error("load_text: read failed");
+                if (fds[1].revents)
+                    return 0;  // cancelled
+                ssize_t got;
+                while ((got = ::read(fd, buf, bytes)) < 0 && errno == EINTR)
+                    ;
+                if (got < 0)
+                    throw runtime_error("load_text: read failed");
+                return got;
+            },
+            chunk_bytes,
+            [wake] {
+                char c = 0;
+                while (::write(wake[1], &c, 1) < 0 && errno == EINTR)
+                    ;
+            });
+        ::close(wake[0]);
+        ::close(wake[1]);
+        return count;
+    } catch (...) {
+        ::close(wake[0]);
+        ::close(wake[1]);
+        throw;
+    }
+}
+/**
+ * the same from a file.
+ */
+template <class Deque>
+size_t load_text(Deque& dst, const char* path, size_t chunk_bytes = 1 << 20) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        throw runtime_error("load_text: cannot open file");
+    try {
+        size_t count = load_text(dst, fd, chunk_bytes);
+        ::close(fd);
+        return count;
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+/**
+ * the same from an istream. an istream read cannot be interrupted, so
+ * after a bad token this waits for the read in progress to return.
+ */
+template <class Deque>
+size_t load_text(Deque& dst, std::istream& is, size_t chunk_bytes = 1 << 20) {
+    return load_chunks(
+        dst,
+        [&is](char* buf, size_t bytes) -> size_t {
+            is.read(buf, bytes);
+            if (is.bad())
+                throw runtime_error("load_text: read failed");
+            return is.gcount();
+        },
+        chunk_bytes);
+}
+}  // namespace sjtu
+
+#endif